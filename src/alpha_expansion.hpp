@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "maxflow.hpp"
+#include "instance_reader.hpp"
+#include "pixel_grid.hpp"
+
+
+/* A driver for the successive moves of an alpha-expansion on a 4-connected pixel grid, each move
+being a maximum flow instance on the grid (see PixelGrid). Each move fills the slots of the grid's
+links with its capacities, streamed from its file without building a FlowNetwork and without
+searching the arcs. The residual network is then rebuilt in place, in buffers allocated once for the
+whole grid, with the links of nonzero capacity only (the moves leave many terminal links empty), and
+the solver keeps its arrays.
+
+With flow reuse (as in Kohli and Torr's dynamic graph cuts), the flow of the previous move is kept as
+far as the new capacities allow it: the flow of each link between pixels is capped by its new
+capacity, then each pixel's imbalance is routed through its terminal links. When these are too
+small, the same amount δ is added to both of them, which adds δ to every cut (so the minimum cut is
+unchanged) and is subtracted from the flow value. The solver then only augments from there. */
+struct AlphaExpansion : PixelGrid
+{
+    bool reuse_flow;
+    DinitzCherkassky<> solver;
+    std::vector<flow_t> capacity, reverse_capacity; // of link LinkCount * p + Link in the current move
+    std::vector<std::int64_t> link_flow; // net flow along each link in the previous move
+    std::vector<ResidualArc*> link_arc; // residual arc of each link, null for an empty link
+    std::vector<arc_t> first_out;
+    std::vector<std::int64_t> imbalance; // inflow minus outflow of each node through the links between pixels
+
+    static ResidualNetwork allocate_grid(size_t width, size_t height) {
+        ResidualNetwork rnetwork(width * height + 2, 0, 1);
+        rnetwork.adjlist.reserve(2 * LinkCount * width * height);
+        return rnetwork;
+    }
+
+    AlphaExpansion(size_t width, size_t height, bool reuse_flow) : PixelGrid{width, height}, reuse_flow(reuse_flow),
+        solver(allocate_grid(width, height)), capacity(LinkCount * width * height),
+        reverse_capacity(LinkCount * width * height), link_flow(reuse_flow ? LinkCount * width * height : 0, 0),
+        link_arc(LinkCount * width * height), first_out(width * height + 4), imbalance(reuse_flow ? width * height + 2 : 0) {}
+
+    ResidualNetwork& rnetwork() { return solver.rnetwork; }
+
+    /* Rebuilds the residual network from the capacities of the links, in place. */
+    void build_residual_network() {
+        auto& rnetwork = this->rnetwork();
+        std::ranges::fill(first_out, 0);
+        for (size_t l = 0; l < std::size(capacity); ++l)
+            if (capacity[l] != 0 or reverse_capacity[l] != 0) {
+                auto const [u, v] = ends(l);
+                ++first_out[u + 2]; ++first_out[v + 2];
+            }
+        for (size_t u = 0; u <= rnetwork.n; ++u) first_out[u + 1] += first_out[u];
+        rnetwork.m = first_out.back();
+        rnetwork.adjlist.resize(rnetwork.m); // within the capacity reserved for the whole grid
+        for (auto u : rnetwork.nodes())
+            rnetwork.arcs_out_span[u] = std::span(rnetwork.adjlist).subspan(first_out[u + 1], first_out[u + 2] - first_out[u + 1]);
+        for (size_t l = 0; l < std::size(capacity); ++l) {
+            link_arc[l] = nullptr;
+            if (capacity[l] == 0 and reverse_capacity[l] == 0) continue;
+            auto const [u, v] = ends(l);
+            auto& arc = rnetwork.adjlist[first_out[u + 1]++];
+            auto& twin = rnetwork.adjlist[first_out[v + 1]++];
+            arc = {v, capacity[l], &twin};
+            twin = {u, reverse_capacity[l], &arc};
+            link_arc[l] = &arc;
+        }
+    }
+
+    /* Solves the move of the given instance file, returns its maximum flow value. */
+    flow_t solve_move(std::string_view filepath) {
+        auto& rnetwork = this->rnetwork();
+        FlowNetwork move;
+        std::ranges::fill(capacity, 0);
+        std::ranges::fill(reverse_capacity, 0);
+        scan_maxflow_instance(filepath, move, [&](CapacityArc const& arc) {
+            auto const [l, along] = link(arc.tail, arc.head);
+            (along ? capacity : reverse_capacity)[l] += arc.capacity;
+        });
+        if (move.n != rnetwork.n or move.source != rnetwork.source or move.sink != rnetwork.sink)
+            throw std::runtime_error("The move doesn't match the grid.");
+        if (!reuse_flow) {
+            build_residual_network();
+            return solver.solve();
+        }
+
+        // keep the previous flow between pixels within the new capacities
+        auto const kept_flow = [&](size_t l) {
+            return std::clamp(link_flow[l], -std::int64_t{reverse_capacity[l]}, std::int64_t{capacity[l]});
+        };
+        std::ranges::fill(imbalance, 0);
+        for (size_t l = 0; l < std::size(capacity); ++l)
+            if (l % LinkCount == RightLink or l % LinkCount == DownLink) {
+                auto const [u, v] = ends(l);
+                imbalance[u] -= kept_flow(l);
+                imbalance[v] += kept_flow(l);
+            }
+
+        // then route the imbalance of each pixel through its terminal links, enlarged if needed
+        auto const source_flow = [&](node_t p) { return static_cast<flow_t>(std::max(-imbalance[p], std::int64_t{0})); };
+        auto const sink_flow = [&](node_t p) { return static_cast<flow_t>(std::max(imbalance[p], std::int64_t{0})); };
+        flow_t initial_flow = 0, offset = 0;
+        for (size_t i = 0; i < pixel_count(); ++i) {
+            auto const p = static_cast<node_t>(i + 2);
+            auto& source_capacity = capacity[LinkCount * i + SourceLink];
+            auto& sink_capacity = capacity[LinkCount * i + SinkLink];
+            auto const delta = std::max(source_flow(p) - std::min(source_flow(p), source_capacity),
+                                        sink_flow(p) - std::min(sink_flow(p), sink_capacity));
+            source_capacity += delta;
+            sink_capacity += delta;
+            offset += delta;
+            initial_flow += source_flow(p);
+        }
+
+        build_residual_network();
+        for (size_t l = 0; l < std::size(capacity); ++l) {
+            if (!link_arc[l]) continue;
+            auto const [u, v] = ends(l);
+            auto const flow = l % LinkCount == SourceLink ? std::int64_t{source_flow(v)}
+                : l % LinkCount == SinkLink ? std::int64_t{sink_flow(u)} : kept_flow(l);
+            if (flow > 0) link_arc[l]->push_flow(static_cast<flow_t>(flow));
+            else link_arc[l]->twin->push_flow(static_cast<flow_t>(-flow));
+        }
+        auto const maxflow = initial_flow + solver.solve() - offset;
+
+        for (size_t l = 0; l < std::size(capacity); ++l)
+            link_flow[l] = link_arc[l] ? std::int64_t{capacity[l]} - link_arc[l]->residual_capacity : 0;
+        return maxflow;
+    }
+};
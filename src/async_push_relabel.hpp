@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* The work-stealing deque of Chase and Lev (with the memory orderings of Lê, Pop, Cohen and Zappa
+Nardelli), used as a queue: its owner pushes at the bottom and every thread, its owner included, takes
+from the top, without locks. Taking from the bottom as well (the LIFO end) would make the owner
+discharge the nodes depth-first, which degenerates push-relabel (hundreds of times more pushes on the
+tsukuba instances). The circular buffer doubles when full, the previous buffers are kept until
+destruction since another thread may still read from them. */
+template <typename T>
+struct WorkStealingQueue
+{
+    struct Buffer
+    {
+        size_t capacity; // a power of 2
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Buffer(size_t capacity) : capacity(capacity), items(std::make_unique<std::atomic<T>[]>(capacity)) {}
+        T get(std::int64_t i) const { return items[static_cast<size_t>(i) & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T value) { items[static_cast<size_t>(i) & (capacity - 1)].store(value, std::memory_order_relaxed); }
+    };
+
+    std::atomic<std::int64_t> top = 0, bottom = 0;
+    std::atomic<Buffer*> buffer;
+    std::vector<std::unique_ptr<Buffer>> buffers; // the current one last
+
+    explicit WorkStealingQueue(size_t capacity = 1024) {
+        buffers.push_back(std::make_unique<Buffer>(std::bit_ceil(std::max<size_t>(capacity, 2))));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    /* Owner only. */
+    void push(T value) {
+        auto const b = bottom.load(std::memory_order_relaxed);
+        auto const t = top.load(std::memory_order_acquire);
+        auto* a = buffer.load(std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t>(a->capacity) - 1) {
+            buffers.push_back(std::make_unique<Buffer>(2 * a->capacity));
+            for (auto i = t; i < b; ++i) buffers.back()->put(i, a->get(i));
+            a = buffers.back().get();
+            buffer.store(a, std::memory_order_release);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /* Any thread, the least recently pushed item (none if the queue is empty or another thread took
+    it first). */
+    std::optional<T> take() {
+        auto t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto const b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return {};
+        auto const value = buffer.load(std::memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return {};
+        return value;
+    }
+};
+
+
+/* Asynchronous push-relabel algorithm of Hong and He, where the threads discharge active nodes
+without any lock nor barrier. Each thread has a work-stealing queue of active nodes and steals from
+the others when it runs out. A node is discharged by one thread at a time (the one which set its
+active flag), which pushes to its lowest residual neighbor if it is lower, or else relabels it right
+above it: the excesses and the residual capacities of the shared ResidualNetwork are updated with
+atomic fetch-add (through std::atomic_ref), and the labels with compare-and-swap since the global
+relabeling runs concurrently. This one is done by whichever thread notices that the relabeling work
+exceeds O(n + m), while the others keep discharging: it sets the labels to the distances to the sink
+(or n plus the distance to the source) on the reverse residual arcs.
+
+Distances read from a changing network may be wrong, and a residual path from the source to the sink
+may then survive the last active node. So when no node is active anymore, the labels are set to the
+exact distances, no thread running, and the residual arcs out of the source leading to the sink are
+saturated again: the flow is maximum when there is none. Raising the labels only (as in Hong and He's
+nonblocking global relabeling) doesn't need this check in theory, but it lets the labels of the
+excesses bouncing between threads climb far above the distances, where they stay: with 8 threads on a
+single core, it took 1.4 billion pushes to solve tsukuba0 instead of 10 million. */
+struct AsyncPushRelabel
+{
+    ResidualNetwork rnetwork;
+    size_t thread_count;
+    std::vector<std::atomic<std::uint64_t>> excess;
+    std::vector<std::atomic<node_t>> label;
+    std::vector<std::atomic<bool>> is_active; // queued or being discharged
+    std::vector<WorkStealingQueue<node_t>> active;
+    std::atomic<size_t> active_count = 0;
+    std::atomic<size_t> work = 0; // relabeling work since the last global relabeling
+    std::atomic_flag relabeling = ATOMIC_FLAG_INIT;
+    std::vector<node_t> distance, bfs_ordering; // of the global relabeling
+
+    static constexpr auto NoLabel = std::numeric_limits<node_t>::max();
+    static constexpr size_t RelabelWork = 12; // cost of a relabel, in addition to the scanned arcs
+
+    /* The work which triggers a global relabeling: a relabel of every node and two scans of the arcs. */
+    size_t global_relabel_threshold() const { return RelabelWork * rnetwork.n + 2 * rnetwork.m; }
+
+    AsyncPushRelabel(ResidualNetwork rnetwork, size_t thread_count) : rnetwork(std::move(rnetwork)),
+        thread_count(std::max<size_t>(thread_count, 1)), excess(this->rnetwork.n), label(this->rnetwork.n),
+        is_active(this->rnetwork.n), active(this->thread_count), distance(this->rnetwork.n),
+        bfs_ordering(this->rnetwork.n) {}
+
+    static std::atomic_ref<flow_t> residual_capacity(ResidualArc& arc) { return std::atomic_ref(arc.residual_capacity); }
+
+    /* Algorithm's main loop, returns the maximum flow value (the flow itself is left in rnetwork). */
+    flow_t solve() {
+        global_relabel(false);
+        while (saturate_source_arcs()) {
+            std::vector<std::jthread> workers;
+            for (size_t i = 1; i < thread_count; ++i) workers.emplace_back([this, i] { run(i); });
+            run(0);
+            workers.clear();
+            global_relabel(false);
+        }
+        return static_cast<flow_t>(excess[rnetwork.sink].load());
+    }
+
+    /* Saturates the residual arcs out of the source whose head can reach the sink (no thread running),
+    returns whether there was any. */
+    bool saturate_source_arcs() {
+        bool saturated = false;
+        for (auto& arc : rnetwork.arcs_out(rnetwork.source))
+            if (auto const rc = arc.residual_capacity; rc != 0 and label[arc.head] < rnetwork.n) {
+                arc.push_flow(rc);
+                excess[arc.head] += rc;
+                activate(arc.head, 0);
+                saturated = true;
+            }
+        return saturated;
+    }
+
+    Flow operator()(FlowNetwork const& network) {
+        auto const maxflow = solve();
+        return {maxflow, get_flow_arcs(network, rnetwork)};
+    }
+
+    /* Thread i's loop: discharges its own active nodes, then stolen ones, until there is none left. */
+    void run(size_t i) {
+        while (active_count.load() != 0) {
+            auto u = active[i].take();
+            for (size_t j = 1; !u and j < thread_count; ++j) u = active[(i + j) % thread_count].take();
+            if (!u) {
+                std::this_thread::yield();
+                continue;
+            }
+            discharge(*u, i);
+            if (work.load(std::memory_order_relaxed) > global_relabel_threshold() and !relabeling.test_and_set()) {
+                global_relabel(true);
+                relabeling.clear();
+            }
+        }
+    }
+
+    void activate(node_t v, size_t i) {
+        if (v == rnetwork.source or v == rnetwork.sink or is_active[v].exchange(true)) return;
+        ++active_count;
+        active[i].push(v);
+    }
+
+    /* Pushes the excess of u to its lowest neighbors, relabeling u when they aren't below it, until u
+    has no excess left. An excess arriving meanwhile is either seen here or activates u again. */
+    void discharge(node_t u, size_t i) {
+        size_t scanned = 0;
+        while (true) {
+            auto const e = excess[u].load();
+            if (e == 0) {
+                is_active[u].store(false);
+                if (excess[u].load() != 0 and !is_active[u].exchange(true)) continue;
+                break;
+            }
+            ResidualArc* lowest = nullptr;
+            auto lowest_label = NoLabel;
+            for (auto& arc : rnetwork.arcs_out(u))
+                if (residual_capacity(arc).load(std::memory_order_relaxed) != 0)
+                    if (auto const l = label[arc.head].load(std::memory_order_relaxed); l < lowest_label) {
+                        lowest = &arc;
+                        lowest_label = l;
+                    }
+            scanned += std::size(rnetwork.arcs_out(u));
+            auto current = label[u].load();
+            if (current > lowest_label) {
+                auto const delta = static_cast<flow_t>(std::min<std::uint64_t>(e, residual_capacity(*lowest).load()));
+                residual_capacity(*lowest).fetch_sub(delta); // only u's discharge decreases it
+                residual_capacity(*lowest->twin).fetch_add(delta);
+                excess[u].fetch_sub(delta);
+                excess[lowest->head].fetch_add(delta);
+                activate(lowest->head, i);
+            } else {
+                scanned += RelabelWork;
+                while (current <= lowest_label and !label[u].compare_exchange_weak(current, lowest_label + 1));
+            }
+        }
+        work.fetch_add(scanned, std::memory_order_relaxed);
+        --active_count;
+    }
+
+    /* Sets the labels to the distances to the sink in the residual network, or to n plus the distance
+    to the source for the nodes which can't reach the sink, with two "queue-less" BFS on the reverse
+    residual arcs. While the other threads push (concurrent), the nodes which aren't reached keep their
+    label (they may have received an excess since). */
+    void global_relabel(bool concurrent) {
+        work = 0;
+        std::ranges::fill(distance, NoLabel);
+        distance[rnetwork.sink] = 0;
+        distance[rnetwork.source] = static_cast<node_t>(rnetwork.n);
+        auto last = begin(bfs_ordering);
+        auto const bfs = [&](node_t root) {
+            *(last++) = root;
+            for (auto u = last - 1; u != last; ++u)
+                for (auto& arc : rnetwork.arcs_out(*u))
+                    if (distance[arc.head] == NoLabel and residual_capacity(*arc.twin).load(std::memory_order_relaxed) != 0) {
+                        distance[arc.head] = distance[*u] + 1;
+                        *(last++) = arc.head;
+                    }
+        };
+        bfs(rnetwork.sink);
+        bfs(rnetwork.source);
+        for (auto u : rnetwork.nodes())
+            if (distance[u] != NoLabel) label[u] = distance[u];
+            else if (!concurrent) label[u] = static_cast<node_t>(2 * rnetwork.n); // no excess can be there
+    }
+};
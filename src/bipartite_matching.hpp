@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* The structure of an assignment problem encoded as a flow network: unit arcs from the source to the
+left nodes, arcs from the left nodes to the right nodes, and unit arcs from the right nodes to the
+sink. The maximum flow is then a maximum matching of the bipartite graph (left, right). Only the
+middle arcs are kept, in CSR form over the left nodes, with their index in the network. */
+struct BipartiteGraph
+{
+    size_t left_count, right_count;
+    std::vector<arc_t> first_out; // the arcs out of left node i are [first_out[i], first_out[i + 1])
+    std::vector<node_t> heads; // index of the right node
+    std::vector<arc_t> network_arcs; // index of the arc in FlowNetwork::arcs
+    std::vector<arc_t> source_arc, sink_arc; // arc from the source to each left node (resp. right node to the sink)
+};
+
+
+/* Detects whether the network is a unit-capacity bipartite matching: every node other than the
+terminals is either a left node (exactly one arc from the source, of capacity 1) or a right node
+(exactly one arc to the sink, of capacity 1), and every other arc goes from a left node to a right
+node (its capacity is then irrelevant, as long as it is positive). Returns the bipartite graph in
+linear time, or nothing if the network doesn't have this structure. */
+inline std::optional<BipartiteGraph> detect_bipartite_matching(FlowNetwork const& network)
+{
+    constexpr auto None = std::numeric_limits<node_t>::max();
+    enum class Side : std::uint8_t { Unknown, Left, Right };
+
+    std::vector<Side> side(network.n, Side::Unknown);
+    std::vector<node_t> index(network.n, None); // index of the node on its side
+    BipartiteGraph graph{};
+    for (arc_t a = 0; a < network.m; ++a) {
+        auto const [u, v, capacity] = network.arcs[a];
+        bool const from_source = u == network.source, to_sink = v == network.sink;
+        if (u == network.sink or v == network.source or (from_source and to_sink)) return {};
+        if (!from_source and !to_sink) continue; // checked once the sides are known
+        auto const w = from_source ? v : u;
+        if (capacity != 1 or side[w] != Side::Unknown) return {};
+        side[w] = from_source ? Side::Left : Side::Right;
+        index[w] = static_cast<node_t>(from_source ? graph.left_count++ : graph.right_count++);
+        (from_source ? graph.source_arc : graph.sink_arc).push_back(a);
+    }
+
+    graph.first_out.assign(graph.left_count + 1, 0);
+    for (auto const& [u, v, capacity] : network.arcs) {
+        if (u == network.source or v == network.sink) continue;
+        if (side[u] != Side::Left or side[v] != Side::Right or capacity == 0) return {};
+        ++graph.first_out[index[u] + 1];
+    }
+    for (size_t i = 0; i < graph.left_count; ++i) graph.first_out[i + 1] += graph.first_out[i];
+
+    auto cursor = graph.first_out;
+    graph.heads.resize(graph.first_out.back());
+    graph.network_arcs.resize(graph.first_out.back());
+    for (arc_t a = 0; a < network.m; ++a) {
+        auto const [u, v, capacity] = network.arcs[a];
+        if (u == network.source or v == network.sink) continue;
+        auto const position = cursor[index[u]]++;
+        graph.heads[position] = index[v];
+        graph.network_arcs[position] = a;
+    }
+    return graph;
+}
+
+
+/* Hopcroft and Karp's maximum bipartite matching algorithm, O(m√n). It is Dinitz's algorithm on the
+unit network of a matching, without any capacity or twin arc: the residual network is implied by the
+matching itself. Each phase computes the distances of the left nodes from the free left nodes with a
+BFS (alternating between unmatched and matched arcs), then finds a maximal set of node-disjoint
+shortest augmenting paths with DFS. A right node is visited at most once per phase, either it ends
+an augmenting path or it leads nowhere, so the visited ones are marked in a bitset. */
+struct HopcroftKarp
+{
+    BipartiteGraph graph;
+    std::vector<node_t> match_left, match_right; // matched node of each left (resp. right) node
+    std::vector<node_t> distance; // BFS layer of each left node
+    std::vector<arc_t> current_arc;
+    std::vector<std::uint64_t> visited; // bitset of the right nodes visited during the phase
+    std::vector<node_t> bfs_ordering; // used for the "queue-less" BFS
+    std::vector<node_t> path; // the left nodes of the DFS path
+
+    static constexpr auto None = std::numeric_limits<node_t>::max(); // unmatched, or unreached
+
+    HopcroftKarp(BipartiteGraph graph) : graph(std::move(graph)),
+        match_left(this->graph.left_count, None), match_right(this->graph.right_count, None),
+        distance(this->graph.left_count), current_arc(this->graph.left_count),
+        visited((this->graph.right_count + 63) / 64), bfs_ordering(this->graph.left_count) {}
+
+    /* Algorithm's main loop, returns the size of the maximum matching. */
+    flow_t solve() {
+        flow_t matching_size = 0;
+        while (bfs_compute_distance()) {
+            std::ranges::copy(begin(graph.first_out), end(graph.first_out) - 1, begin(current_arc));
+            std::ranges::fill(visited, 0);
+            for (node_t u = 0; u < graph.left_count; ++u)
+                if (match_left[u] == None and augment_from(u)) ++matching_size;
+        }
+        return matching_size;
+    }
+
+    /* The maximum flow on the original network: one unit through each matched pair. */
+    Flow operator()(FlowNetwork const& network) {
+        Flow flow{solve(), std::vector<flow_t>(network.m, 0)};
+        for (node_t u = 0; u < graph.left_count; ++u) {
+            if (match_left[u] == None) continue;
+            flow.flow_arcs[graph.source_arc[u]] = 1;
+            flow.flow_arcs[graph.sink_arc[match_left[u]]] = 1;
+            auto const arcs = std::span(graph.heads).subspan(graph.first_out[u], graph.first_out[u + 1] - graph.first_out[u]);
+            auto const position = graph.first_out[u] + (std::ranges::find(arcs, match_left[u]) - begin(arcs));
+            flow.flow_arcs[graph.network_arcs[position]] = 1;
+        }
+        return flow;
+    }
+
+    bool is_visited(node_t v) const { return visited[v / 64] >> (v % 64) & 1; }
+    void visit(node_t v) { visited[v / 64] |= std::uint64_t{1} << (v % 64); }
+
+    /* BFS from all the free left nodes at once, a right node leading to its matched left node. Returns
+    whether a free right node is reachable, i.e. whether there is an augmenting path. */
+    bool bfs_compute_distance() {
+        std::ranges::fill(distance, None);
+        auto last = begin(bfs_ordering);
+        for (node_t u = 0; u < graph.left_count; ++u)
+            if (match_left[u] == None) {
+                distance[u] = 0;
+                *(last++) = u;
+            }
+        bool augmentable = false;
+        for (auto u = begin(bfs_ordering); u != last; ++u)
+            for (auto a = graph.first_out[*u]; a < graph.first_out[*u + 1]; ++a) {
+                auto const w = match_right[graph.heads[a]];
+                if (w == None) augmentable = true;
+                else if (distance[w] == None) {
+                    distance[w] = distance[*u] + 1;
+                    *(last++) = w;
+                }
+            }
+        return augmentable;
+    }
+
+    /* Iterative DFS from the free left node root along the BFS layers, flipping the path it finds
+    (the recursion depth could reach the number of left nodes). A left node whose arcs are exhausted
+    is a dead end for the rest of the phase. */
+    bool augment_from(node_t root) {
+        path.assign(1, root);
+        while (!path.empty()) {
+            auto const u = path.back();
+            auto& a = current_arc[u];
+            for (; a < graph.first_out[u + 1]; ++a) {
+                auto const v = graph.heads[a];
+                if (is_visited(v)) continue;
+                auto const w = match_right[v];
+                if (w == None or distance[w] == distance[u] + 1) break;
+            }
+            if (a == graph.first_out[u + 1]) {
+                distance[u] = None;
+                path.pop_back();
+                continue;
+            }
+            auto const v = graph.heads[a];
+            visit(v);
+            if (match_right[v] != None) {
+                path.push_back(match_right[v]);
+                continue;
+            }
+            for (auto x : path) { // the right node of each left node of the path is its current arc head
+                auto const y = graph.heads[current_arc[x]];
+                match_left[x] = y;
+                match_right[y] = x;
+            }
+            return true;
+        }
+        return false;
+    }
+};
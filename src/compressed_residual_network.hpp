@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <vector>
+#include "maxflow.hpp"
+#include "parallel.hpp"
+
+
+/* An arc of CompressedResidualNetwork, decoded on the fly: its index in the residual capacities
+array, its tail and its head. */
+struct CompressedArc
+{
+    arc_t index;
+    node_t tail, head;
+};
+
+
+/* Forward iterator over the compressed adjacency list of a node, decoding one head at a time. */
+struct CompressedArcIterator
+{
+    using value_type = CompressedArc;
+    using difference_type = std::ptrdiff_t;
+
+    std::uint8_t const* bytes = nullptr; // the encoding of the next head
+    CompressedArc arc{};
+    arc_t last = 0; // index of the end of the list
+
+    /* LEB128 variable length integer: 7 bits per byte, the high bit set on all the bytes but the last. */
+    static std::uint64_t read_varint(std::uint8_t const*& bytes) {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            auto const byte = *(bytes++);
+            value |= std::uint64_t{byte & 0x7fu} << shift;
+            if (!(byte & 0x80)) return value;
+        }
+    }
+
+    /* The first head is encoded relative to the tail, as a "zigzag" signed difference. */
+    static node_t first_head(node_t tail, std::uint8_t const*& bytes) {
+        auto const zigzag = read_varint(bytes);
+        auto const difference = static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+        return static_cast<node_t>(tail + difference);
+    }
+
+    CompressedArc operator*() const { return arc; }
+    CompressedArcIterator& operator++() {
+        if (++arc.index < last) arc.head += static_cast<node_t>(read_varint(bytes));
+        return *this;
+    }
+    CompressedArcIterator operator++(int) { auto previous = *this; ++*this; return previous; }
+    bool operator==(CompressedArcIterator const& other) const { return arc.index == other.arc.index; }
+};
+
+
+/* Residual network for graphs which don't fit in memory with 16 bytes per residual arc. Each node's
+adjacency list is sorted by head and stored as a byte stream of variable length integers: the first
+head relative to the node, then the differences between consecutive heads (1 or 2 bytes each on
+grids). The residual capacities are in a separate array, indexed as in a CSR layout. All the arcs
+between two nodes (parallel and antiparallel) are merged into a single pair of residual arcs, so a
+head appears once per list and the reverse arc of (u, v) is implicit: it is the position of u in v's
+list, found with a skip index (the head and position of every SkipInterval-th arc) and at most
+SkipInterval decoded heads. About 13 bytes per residual arc with the node arrays on the tsukuba
+instances, against 19 for ResidualNetwork, for the price of decoding the heads during the scans and of
+searching the reverse arcs during the pushes. Solvers run on it unmodified through the common
+adjacency interface (see ResidualGraph).
+
+The residual capacities are kept in 64 bits: those of a pair always sum to the capacities it merges,
+which may exceed a flow_t. The solvers see them capped at the largest flow_t, which changes no cut
+below it, so the maximum flow is the same as long as its value fits in a flow_t (which they all
+assume), and they never push more than a flow_t at once. */
+struct CompressedResidualNetwork
+{
+    struct SkipEntry
+    {
+        node_t head; // head of the arc SkipInterval * (i + 1) of the list, for the i-th entry
+        std::uint64_t next_byte; // where the encoding of the following head starts
+    };
+
+    static constexpr arc_t SkipInterval = 64;
+    static constexpr auto NoArc = std::numeric_limits<arc_t>::max();
+
+    size_t n, m; // number of vertices (resp. residual arcs)
+    node_t source, sink;
+    std::vector<arc_t> first_out; // the arcs out of u are [first_out[u], first_out[u + 1])
+    std::vector<std::uint64_t> first_byte; // the encoding of u's list starts at heads[first_byte[u]]
+    std::vector<std::uint8_t> heads;
+    std::vector<arc_t> first_skip; // u's skip entries are [first_skip[u], first_skip[u + 1])
+    std::vector<SkipEntry> skips;
+    mutable std::vector<std::uint64_t> residual_capacities; // exact, see above
+
+    auto nodes() const { return std::ranges::iota_view{node_t{0}, n}; }
+    auto arcs_out(node_t node) const {
+        CompressedArcIterator first{heads.data() + first_byte[node], {first_out[node], node, 0}, first_out[node + 1]};
+        if (first_out[node] != first_out[node + 1]) first.arc.head = CompressedArcIterator::first_head(node, first.bytes);
+        CompressedArcIterator last{nullptr, {first_out[node + 1], node, 0}, first_out[node + 1]};
+        return std::ranges::subrange(first, last);
+    }
+    auto degree_out(node_t node) const { return size_t{first_out[node + 1] - first_out[node]}; }
+
+    // the common adjacency interface (see ResidualGraph), a reverse arc is only known by its index
+    static node_t head(CompressedArc const& arc) { return arc.head; }
+    arc_t twin(CompressedArc const& arc) const { return find_arc(arc.head, arc.tail); }
+    flow_t residual_capacity(CompressedArc const& arc) const { return residual_capacity(arc.index); }
+    flow_t residual_capacity(arc_t index) const {
+        return static_cast<flow_t>(std::min<std::uint64_t>(residual_capacities[index], std::numeric_limits<flow_t>::max()));
+    }
+    void push_flow(CompressedArc const& arc, flow_t flow) const {
+        residual_capacities[arc.index] -= flow;
+        residual_capacities[twin(arc)] += flow;
+    }
+
+    /* Index of the arc (u, v), NoArc if there is none. */
+    arc_t find_arc(node_t u, node_t v) const {
+        auto const first = begin(skips) + first_skip[u], last = begin(skips) + first_skip[u + 1];
+        auto const skip = std::ranges::upper_bound(first, last, v, {}, &SkipEntry::head);
+        auto index = first_out[u];
+        std::uint8_t const* bytes = heads.data() + first_byte[u];
+        node_t head;
+        if (skip == first) {
+            if (index == first_out[u + 1]) return NoArc;
+            head = CompressedArcIterator::first_head(u, bytes);
+        } else {
+            index += SkipInterval * static_cast<arc_t>(skip - first);
+            head = (skip - 1)->head;
+            bytes = heads.data() + (skip - 1)->next_byte;
+        }
+        while (head < v) {
+            if (++index == first_out[u + 1]) return NoArc;
+            head += static_cast<node_t>(CompressedArcIterator::read_varint(bytes));
+        }
+        return head == v ? index : NoArc;
+    }
+
+    CompressedResidualNetwork(FlowNetwork const& network) : n(network.n), m(0), source(network.source),
+        sink(network.sink), first_out(n + 1, 0), first_byte(n + 1, 0), first_skip(n + 1, 0)
+    {
+        // the neighbors of each node with the capacity towards them, sorted and merged
+        struct Neighbor { node_t node; std::uint64_t capacity; };
+        std::vector<arc_t> neighbors_first(n + 1, 0);
+        for (auto const& [u, v, capacity] : network.arcs)
+            if (u != v) { ++neighbors_first[u + 1]; ++neighbors_first[v + 1]; }
+        for (size_t u = 0; u < n; ++u) neighbors_first[u + 1] += neighbors_first[u];
+        std::vector<Neighbor> neighbors(neighbors_first.back());
+        {
+            std::vector<arc_t> cursor(begin(neighbors_first), end(neighbors_first) - 1);
+            for (auto const& [u, v, capacity] : network.arcs)
+                if (u != v) { neighbors[cursor[u]++] = {v, capacity}; neighbors[cursor[v]++] = {u, 0}; }
+        }
+        std::vector<arc_t> degree(n);
+        parallel_for(n, [&](size_t first, size_t last) {
+            for (auto u = first; u < last; ++u) {
+                auto const list = std::span(neighbors).subspan(neighbors_first[u], neighbors_first[u + 1] - neighbors_first[u]);
+                std::ranges::sort(list, {}, &Neighbor::node);
+                size_t unique = 0;
+                for (size_t i = 0; i < std::size(list); ++i) {
+                    if (unique > 0 and list[unique - 1].node == list[i].node) list[unique - 1].capacity += list[i].capacity;
+                    else list[unique++] = list[i];
+                }
+                degree[u] = static_cast<arc_t>(unique);
+            }
+        }, 1 << 12);
+
+        // the sizes of the encoded lists and of their skip indices
+        auto const varint_size = [](std::uint64_t value) { size_t size = 1; while (value >>= 7) ++size; return size; };
+        auto const zigzag = [](node_t tail, node_t head) {
+            auto const difference = static_cast<std::int64_t>(head) - static_cast<std::int64_t>(tail);
+            return static_cast<std::uint64_t>((difference << 1) ^ (difference >> 63));
+        };
+        parallel_for(n, [&](size_t first, size_t last) {
+            for (auto u = first; u < last; ++u) {
+                auto const list = neighbors.data() + neighbors_first[u];
+                size_t bytes = 0;
+                for (arc_t i = 0; i < degree[u]; ++i)
+                    bytes += varint_size(i == 0 ? zigzag(static_cast<node_t>(u), list[0].node) : list[i].node - list[i - 1].node);
+                first_byte[u + 1] = bytes;
+                first_out[u + 1] = degree[u];
+                first_skip[u + 1] = degree[u] == 0 ? 0 : (degree[u] - 1) / SkipInterval;
+            }
+        }, 1 << 12);
+        for (size_t u = 0; u < n; ++u) {
+            first_out[u + 1] += first_out[u];
+            first_byte[u + 1] += first_byte[u];
+            first_skip[u + 1] += first_skip[u];
+        }
+        m = first_out.back();
+        heads.resize(first_byte.back());
+        skips.resize(first_skip.back());
+        residual_capacities.resize(m);
+
+        // encoding
+        parallel_for(n, [&](size_t first, size_t last) {
+            for (auto u = first; u < last; ++u) {
+                auto const list = neighbors.data() + neighbors_first[u];
+                auto bytes = heads.data() + first_byte[u];
+                for (arc_t i = 0; i < degree[u]; ++i) {
+                    auto value = i == 0 ? zigzag(static_cast<node_t>(u), list[0].node) : list[i].node - list[i - 1].node;
+                    for (; value >= 0x80; value >>= 7) *(bytes++) = static_cast<std::uint8_t>(value | 0x80);
+                    *(bytes++) = static_cast<std::uint8_t>(value);
+                    residual_capacities[first_out[u] + i] = list[i].capacity;
+                    if (i > 0 and i % SkipInterval == 0)
+                        skips[first_skip[u] + i / SkipInterval - 1] = {list[i].node, static_cast<std::uint64_t>(bytes - heads.data())};
+                }
+            }
+        }, 1 << 12);
+    }
+
+    /* The flow of each input arc. The net flow of a merged pair of residual arcs is its capacity minus
+    its residual capacity, it is shared among the input arcs it merges in their order. */
+    std::vector<flow_t> flow_arcs(FlowNetwork const& network) const {
+        std::vector<std::uint64_t> remaining(m, 0); // total capacity, then net flow left to share of each arc
+        for (auto const& [u, v, capacity] : network.arcs)
+            if (u != v) remaining[find_arc(u, v)] += capacity;
+        for (size_t a = 0; a < m; ++a)
+            remaining[a] = remaining[a] > residual_capacities[a] ? remaining[a] - residual_capacities[a] : 0;
+        std::vector<flow_t> flow_arcs(network.m, 0);
+        for (size_t a = 0; a < network.m; ++a) {
+            auto const [u, v, capacity] = network.arcs[a];
+            if (u == v) continue;
+            auto& left = remaining[find_arc(u, v)];
+            flow_arcs[a] = static_cast<flow_t>(std::min<std::uint64_t>(capacity, left));
+            left -= flow_arcs[a];
+        }
+        return flow_arcs;
+    }
+};
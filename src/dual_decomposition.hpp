@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "maxflow.hpp"
+#include "incremental_bfs.hpp"
+#include "parallel.hpp"
+#include "pixel_grid.hpp"
+
+
+/* A cut of a pixel grid instance, with a lower bound on the minimum cut capacity which certifies it
+when they are equal. */
+struct GridCut
+{
+    std::vector<bool> sink_side; // of each node of the instance
+    std::int64_t value, lower_bound;
+    size_t iterations; // of the decomposition
+    size_t pieces; // in the end
+
+    bool optimal() const { return value == lower_bound; }
+};
+
+
+/* Strandmark and Kahl's parallel graph cuts by dual decomposition: the grid is split into vertical
+strips of columns, consecutive strips sharing a column, and each strip is solved independently (one
+thread each). The links of a shared column are given to the left strip, and each of its pixels p has
+a Lagrange multiplier λ(p), which adds λ(p) to the cost of p being on the sink side in the left strip
+and subtracts it in the right one (a negative cost going to the other terminal link, plus a constant).
+Whatever the multipliers, the sum of the strips' minimum cuts is a lower bound on the grid's minimum
+cut, which it reaches when the strips agree on the side of every shared pixel: their cuts then form a
+minimum cut of the grid. Otherwise each disagreeing λ(p) moves by the step in the direction of the
+agreement (a subgradient step), the step being halved whenever the number of disagreements doesn't
+decrease. Once the step is down to 1, the multipliers may oscillate around fractional values: the
+strips which still disagree along a shared column are then merged, so that the decomposition always
+ends, at worst with the whole grid as a single strip. The strips are solved with IncrementalBFS,
+which like Boykov and Kolmogorov's algorithm grows search trees from both terminals, and their
+minimum cuts have the smallest source side, so that strips with equal multipliers lean the same way. */
+struct DualDecomposition : PixelGrid
+{
+    struct Piece
+    {
+        size_t first_column, last_column;
+        std::vector<bool> sink_side; // of its pixels, column by column in each row
+        std::int64_t value = 0; // the capacity of its minimum cut, the constant of its multipliers included
+    };
+
+    std::vector<flow_t> capacity, reverse_capacity; // of link LinkCount * p + Link
+    std::vector<size_t> columns; // piece k is the columns [columns[k], columns[k + 1]]
+    std::vector<Piece> pieces;
+    std::vector<std::int64_t> multiplier; // of the pixel of row y in columns[k + 1], at height * k + y
+
+    DualDecomposition(FlowNetwork const& network, size_t width, size_t height, size_t piece_count) :
+        PixelGrid{width, height}, capacity(LinkCount * width * height), reverse_capacity(LinkCount * width * height) {
+        if (width == 0 or network.n != pixel_count() + 2 or network.source != 0 or network.sink != 1)
+            throw std::runtime_error("The instance doesn't match the grid.");
+        for (auto const& arc : network.arcs) {
+            auto const [l, along] = link(arc.tail, arc.head);
+            (along ? capacity : reverse_capacity)[l] += arc.capacity;
+        }
+        piece_count = std::clamp<size_t>(piece_count, 1, std::max<size_t>(width - 1, 1));
+        for (size_t k = 0; k <= piece_count; ++k) columns.push_back(k * (width - 1) / piece_count);
+        for (size_t k = 0; k < piece_count; ++k) pieces.push_back({columns[k], columns[k + 1], {}});
+        multiplier.assign((piece_count - 1) * height, 0);
+    }
+
+    /* The piece which has the links of the pixels of column x (the left one for a shared column). */
+    size_t piece_of(size_t x) const {
+        return std::ranges::lower_bound(begin(columns) + 1, end(columns), x) - (begin(columns) + 1);
+    }
+
+    /* Builds and solves piece k, or the whole grid if the piece covers it. */
+    void solve_piece(Piece& piece, size_t k) const {
+        auto const piece_width = piece.last_column - piece.first_column + 1;
+        auto const whole = piece_width == width;
+        auto const local = [&](size_t x, size_t y) { return static_cast<node_t>(2 + (x - piece.first_column) + y * piece_width); };
+        FlowNetwork network{.n = piece_width * height + 2, .m = 0, .source = 0, .sink = 1, .arcs = {}};
+        std::int64_t constant = 0;
+        auto const add_arcs = [&](node_t u, node_t v, flow_t capacity, flow_t reverse_capacity) {
+            if (capacity != 0) network.arcs.push_back({u, v, capacity});
+            if (reverse_capacity != 0) network.arcs.push_back({v, u, reverse_capacity});
+        };
+        for (size_t y = 0; y < height; ++y)
+            for (auto x = piece.first_column; x <= piece.last_column; ++x) {
+                auto const l = LinkCount * (x + y * width);
+                auto const u = local(x, y);
+                std::int64_t source_capacity = 0, sink_capacity = 0;
+                if (whole or piece_of(x) == k) {
+                    source_capacity = capacity[l + SourceLink];
+                    sink_capacity = capacity[l + SinkLink];
+                    if (y + 1 < height) add_arcs(u, local(x, y + 1), capacity[l + DownLink], reverse_capacity[l + DownLink]);
+                }
+                if (x < piece.last_column) add_arcs(u, local(x + 1, y), capacity[l + RightLink], reverse_capacity[l + RightLink]);
+                if (!whole) { // the cost of u on the sink side
+                    auto const cost = x == piece.last_column and k + 1 < std::size(pieces) ? multiplier[height * k + y]
+                        : x == piece.first_column and k > 0 ? -multiplier[height * (k - 1) + y] : 0;
+                    if (cost > 0) source_capacity += cost;
+                    else sink_capacity -= cost;
+                    constant += std::min<std::int64_t>(cost, 0);
+                }
+                add_arcs(0, u, static_cast<flow_t>(source_capacity), 0);
+                add_arcs(u, 1, static_cast<flow_t>(sink_capacity), 0);
+            }
+        network.m = std::size(network.arcs);
+
+        IncrementalBFS solver(ResidualNetwork{network});
+        piece.value = solver.solve() + constant;
+        piece.sink_side.assign(network.n, true);
+        for (auto u : minimum_cut(solver.rnetwork)) piece.sink_side[u] = false;
+        piece.sink_side.erase(begin(piece.sink_side), begin(piece.sink_side) + 2);
+    }
+
+    GridCut solve() {
+        auto const sink_side = [&](size_t k, size_t x, size_t y) {
+            auto const& piece = pieces[k];
+            return piece.sink_side[x - piece.first_column + y * (piece.last_column - piece.first_column + 1)];
+        };
+        std::int64_t step = 1;
+        for (auto c : capacity) step = std::max<std::int64_t>(step, c / 4);
+        auto previous = std::numeric_limits<size_t>::max();
+        for (size_t iteration = 1;; ++iteration) {
+            parallel_for(std::size(pieces), [&](size_t first, size_t last) {
+                for (auto k = first; k < last; ++k) solve_piece(pieces[k], k);
+            }, 1);
+
+            size_t disagreements = 0;
+            std::vector<bool> disagree(std::size(pieces) - 1, false); // along each shared column
+            for (size_t k = 0; k + 1 < std::size(pieces); ++k)
+                for (size_t y = 0; y < height; ++y)
+                    if (auto const left = sink_side(k, columns[k + 1], y); left != sink_side(k + 1, columns[k + 1], y)) {
+                        multiplier[height * k + y] += left ? step : -step;
+                        disagree[k] = true;
+                        ++disagreements;
+                    }
+            if (disagreements == 0) {
+                GridCut cut{std::vector<bool>(pixel_count() + 2), 0, 0, iteration, std::size(pieces)};
+                cut.sink_side[1] = true;
+                for (size_t y = 0; y < height; ++y)
+                    for (size_t x = 0; x < width; ++x) cut.sink_side[2 + x + y * width] = sink_side(piece_of(x), x, y);
+                for (auto const& piece : pieces) cut.lower_bound += piece.value;
+                cut.value = cut_capacity(cut.sink_side);
+                return cut;
+            }
+            if (disagreements >= previous and step == 1) {
+                for (auto k = std::size(disagree); k-- > 0;)
+                    if (disagree[k]) merge(k);
+                previous = std::numeric_limits<size_t>::max();
+                continue;
+            }
+            if (disagreements >= previous) step = std::max<std::int64_t>(step / 2, 1);
+            previous = disagreements;
+        }
+    }
+
+    /* Merges pieces k and k + 1, dropping the multipliers of the column they shared. */
+    void merge(size_t k) {
+        pieces[k].last_column = pieces[k + 1].last_column;
+        pieces.erase(begin(pieces) + k + 1);
+        columns.erase(begin(columns) + k + 1);
+        multiplier.erase(begin(multiplier) + height * k, begin(multiplier) + height * (k + 1));
+    }
+
+    /* The capacity of the cut of the grid with the given sink side. */
+    std::int64_t cut_capacity(std::vector<bool> const& sink_side) const {
+        std::int64_t value = 0;
+        for (size_t l = 0; l < std::size(capacity); ++l) {
+            if (capacity[l] == 0 and reverse_capacity[l] == 0) continue; // e.g. beyond the border
+            auto const [u, v] = ends(l);
+            if (!sink_side[u] and sink_side[v]) value += capacity[l];
+            if (sink_side[u] and !sink_side[v] and l % LinkCount != SourceLink and l % LinkCount != SinkLink)
+                value += reverse_capacity[l];
+        }
+        return value;
+    }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "maxflow.hpp"
+#include "instance_hash.hpp"
+
+
+/* A maximum flow together with the source side of a minimum cut, as cached by FlowCache. */
+struct MaxflowSolution
+{
+    Flow flow;
+    std::vector<node_t> source_side;
+};
+
+
+/* A LRU cache of maximum flow solutions keyed by the content hash of their flow network, so that
+repeated instances are answered without solving them again. The most recently used solutions are
+kept in memory; if a directory is given, every solution is also stored on disk (one binary file per
+instance) and survives the process. The hash is computed from the network at each call (a network
+may have been modified since any earlier hash), and each solution keeps the sizes, the terminals and
+the arcs checksum of its network, which must match as well. */
+struct FlowCache
+{
+    /* What a solution must match besides the hash. */
+    struct Signature
+    {
+        std::uint64_t checksum, n, m, terminals;
+
+        bool operator==(Signature const&) const = default;
+    };
+    struct Stored
+    {
+        Signature signature;
+        MaxflowSolution solution;
+    };
+    using Entry = std::pair<std::uint64_t, Stored>;
+
+    size_t capacity; // maximum number of solutions kept in memory
+    std::filesystem::path directory; // on-disk storage, disabled if empty
+    std::list<Entry> entries; // the most recently used solution first
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+
+    static constexpr std::uint64_t Magic = 0x3230464d; // "MF02"
+
+    FlowCache(size_t capacity, std::filesystem::path directory = {}) : capacity(capacity),
+        directory(std::move(directory)) {
+        if (!this->directory.empty()) std::filesystem::create_directories(this->directory);
+    }
+
+    /* Returns the cached solution of the network, or nullptr if there is none. The returned pointer
+    is valid until the next insertion. */
+    MaxflowSolution const* find(FlowNetwork const& network) {
+        auto const digest = digest_flow_network(network);
+        return find(digest.hash, signature(network, digest));
+    }
+
+    MaxflowSolution const& insert(FlowNetwork const& network, MaxflowSolution solution) {
+        auto const digest = digest_flow_network(network);
+        return insert(digest.hash, {signature(network, digest), std::move(solution)});
+    }
+
+    /* Returns the cached solution of the network, calling solve(network) to compute and insert it
+    if there is none. The network is digested once. */
+    template <typename Solve>
+    MaxflowSolution const& find_or_solve(FlowNetwork const& network, Solve&& solve) {
+        auto const digest = digest_flow_network(network);
+        auto const expected = signature(network, digest);
+        if (auto solution = find(digest.hash, expected)) return *solution;
+        return insert(digest.hash, {expected, solve(network)});
+    }
+
+private:
+    static Signature signature(FlowNetwork const& network, NetworkDigest const& digest) {
+        return {digest.checksum, network.n, network.m, std::uint64_t{network.source} << 32 | network.sink};
+    }
+
+    /* Guards against hash collisions (and stale files). */
+    static bool valid_for(Signature const& expected, Stored const& stored) {
+        return stored.signature == expected and std::size(stored.solution.flow.flow_arcs) == expected.m
+            and std::size(stored.solution.source_side) <= expected.n;
+    }
+
+    MaxflowSolution const* find(std::uint64_t h, Signature const& expected) {
+        if (auto it = index.find(h); it != end(index)) {
+            entries.splice(begin(entries), entries, it->second);
+            return valid_for(expected, it->second->second) ? &it->second->second.solution : nullptr;
+        }
+        if (auto stored = load(h); stored and valid_for(expected, *stored))
+            return &insert_in_memory(h, std::move(*stored));
+        return nullptr;
+    }
+
+    MaxflowSolution const& insert(std::uint64_t h, Stored stored) {
+        if (!directory.empty()) store(h, stored);
+        return insert_in_memory(h, std::move(stored));
+    }
+
+    MaxflowSolution& insert_in_memory(std::uint64_t h, Stored stored) {
+        if (auto it = index.find(h); it != end(index)) {
+            entries.erase(it->second);
+            index.erase(it);
+        }
+        entries.emplace_front(h, std::move(stored));
+        index[h] = begin(entries);
+        while (std::size(entries) > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        return entries.front().second.solution;
+    }
+
+    std::filesystem::path filepath(std::uint64_t h) const {
+        char filename[24];
+        std::snprintf(filename, sizeof(filename), "%016llx.flow", static_cast<unsigned long long>(h));
+        return directory / filename;
+    }
+
+    /* File layout: magic, hash, the signature (checksum, n, m, terminals), flow value, number of cut
+    nodes, then the flow of each arc and the cut nodes. The file is written aside then renamed, so
+    concurrent readers never see a partial file. */
+    void store(std::uint64_t h, Stored const& stored) const {
+        auto const& [signature, solution] = stored;
+        auto const path = filepath(h);
+        auto tmp_path = path;
+        tmp_path += ".tmp";
+        {
+            std::ofstream file(tmp_path, std::ios::binary);
+            std::uint64_t const header[] = {Magic, h, signature.checksum, signature.n, signature.m,
+                signature.terminals, solution.flow.value, std::size(solution.source_side)};
+            file.write(reinterpret_cast<char const*>(header), sizeof(header));
+            file.write(reinterpret_cast<char const*>(solution.flow.flow_arcs.data()),
+                std::size(solution.flow.flow_arcs) * sizeof(flow_t));
+            file.write(reinterpret_cast<char const*>(solution.source_side.data()),
+                std::size(solution.source_side) * sizeof(node_t));
+            if (!file) return;
+        }
+        std::filesystem::rename(tmp_path, path);
+    }
+
+    std::optional<Stored> load(std::uint64_t h) const {
+        if (directory.empty()) return std::nullopt;
+        std::ifstream file(filepath(h), std::ios::binary);
+        std::uint64_t header[8];
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) return std::nullopt;
+        if (header[0] != Magic or header[1] != h) return std::nullopt;
+
+        Stored stored{{header[2], header[3], header[4], header[5]}, {}};
+        auto& solution = stored.solution;
+        solution.flow.value = static_cast<flow_t>(header[6]);
+        solution.flow.flow_arcs.resize(header[4]);
+        solution.source_side.resize(header[7]);
+        file.read(reinterpret_cast<char*>(solution.flow.flow_arcs.data()), header[4] * sizeof(flow_t));
+        file.read(reinterpret_cast<char*>(solution.source_side.data()), header[7] * sizeof(node_t));
+        if (!file) return std::nullopt;
+        return stored;
+    }
+};
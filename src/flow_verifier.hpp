@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "maxflow.hpp"
+#include "parallel.hpp"
+
+
+/* Outcome of the verification of a flow against its flow network. Each check is independent from
+the others, a flow is a certified maximum flow iff all of them pass. */
+struct FlowCertificate
+{
+    bool capacity_ok = false;     // 0 <= flow(a) <= capacity(a) for every arc
+    bool conservation_ok = false; // inflow = outflow on every node but the terminals, and the net
+                                  // outflow of the source (resp. inflow of the sink) is the flow value
+    bool optimal = false;         // the sink isn't reachable in the residual network and the cut
+                                  // found this way has a capacity equal to the flow value
+
+    explicit operator bool() const { return capacity_ok and conservation_ok and optimal; }
+};
+
+
+/* Checks that the given flow is a maximum flow of the network in O(n + m), without solving the net
+-work again. Optimality is certified by a minimum cut: the set S of nodes reachable from the source
+in the residual network defines an s-t cut (if the sink isn't in S) whose capacity is an upper bound
+of any flow value, so a flow whose value is equal to it is maximum. Arcs are processed in parallel,
+only the residual BFS is sequential. */
+inline FlowCertificate verify_flow(FlowNetwork const& network, Flow const& flow)
+{
+    FlowCertificate certificate;
+    auto const& arcs = network.arcs;
+    if (std::size(flow.flow_arcs) != network.m or std::size(arcs) != network.m) return certificate;
+    if (network.source >= network.n or network.sink >= network.n) return certificate;
+
+    // capacity constraints, also checking that arcs endpoints are valid nodes
+    std::atomic<bool> capacity_ok = true;
+    parallel_for(network.m, [&](size_t first, size_t last) {
+        for (auto a = first; a != last; ++a)
+            if (flow.flow_arcs[a] > arcs[a].capacity or arcs[a].tail >= network.n or arcs[a].head >= network.n) {
+                capacity_ok = false;
+                return;
+            }
+    });
+    certificate.capacity_ok = capacity_ok;
+    if (!certificate.capacity_ok) return certificate;
+
+    // flow conservation, the excess of each node is accumulated with atomic additions
+    std::vector<std::int64_t> excess(network.n, 0);
+    parallel_for(network.m, [&](size_t first, size_t last) {
+        for (auto a = first; a != last; ++a) {
+            auto const f = static_cast<std::int64_t>(flow.flow_arcs[a]);
+            std::atomic_ref(excess[arcs[a].tail]).fetch_sub(f, std::memory_order_relaxed);
+            std::atomic_ref(excess[arcs[a].head]).fetch_add(f, std::memory_order_relaxed);
+        }
+    });
+    std::atomic<bool> conservation_ok = excess[network.sink] == flow.value
+        and excess[network.source] == -static_cast<std::int64_t>(flow.value);
+    parallel_for(network.n, [&](size_t first, size_t last) {
+        for (auto u = first; u != last; ++u)
+            if (excess[u] != 0 and u != network.source and u != network.sink) {
+                conservation_ok = false;
+                return;
+            }
+    });
+    certificate.conservation_ok = conservation_ok;
+
+    // glued lists of the arcs incident to each node (as tail or head), filled in parallel
+    std::vector<size_t> first_incident(network.n + 1, 0);
+    parallel_for(network.m, [&](size_t first, size_t last) {
+        for (auto a = first; a != last; ++a) {
+            std::atomic_ref(first_incident[arcs[a].tail + 1]).fetch_add(1, std::memory_order_relaxed);
+            std::atomic_ref(first_incident[arcs[a].head + 1]).fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (size_t u = 0; u < network.n; ++u) first_incident[u + 1] += first_incident[u];
+    std::vector<size_t> incident(2 * network.m);
+    std::vector<size_t> cursor(begin(first_incident), end(first_incident) - 1);
+    parallel_for(network.m, [&](size_t first, size_t last) {
+        for (auto a = first; a != last; ++a) {
+            incident[std::atomic_ref(cursor[arcs[a].tail]).fetch_add(1, std::memory_order_relaxed)] = a;
+            incident[std::atomic_ref(cursor[arcs[a].head]).fetch_add(1, std::memory_order_relaxed)] = a;
+        }
+    });
+
+    // "queue-less" BFS from the source in the residual network: an arc can be traversed forward if
+    // it isn't saturated, backward if it carries some flow
+    std::vector<std::uint8_t> reached(network.n, false);
+    std::vector<node_t> bfs_ordering(network.n);
+    bfs_ordering[0] = network.source;
+    reached[network.source] = true;
+    auto last = begin(bfs_ordering) + 1;
+    for (auto u = begin(bfs_ordering); u != last; ++u)
+        for (auto i = first_incident[*u]; i != first_incident[*u + 1]; ++i) {
+            auto const a = incident[i];
+            auto const [tail, head, capacity] = arcs[a];
+            node_t v = tail == *u ? head : tail;
+            bool const residual = (tail == *u and flow.flow_arcs[a] < capacity)
+                               or (head == *u and flow.flow_arcs[a] > 0);
+            if (residual and !reached[v]) {
+                reached[v] = true;
+                *(last++) = v;
+            }
+        }
+
+    // capacity of the cut (S, V \ S)
+    std::atomic<std::uint64_t> cut_capacity = 0;
+    parallel_for(network.m, [&](size_t first, size_t last) {
+        std::uint64_t capacity = 0;
+        for (auto a = first; a != last; ++a)
+            if (reached[arcs[a].tail] and !reached[arcs[a].head]) capacity += arcs[a].capacity;
+        cut_capacity += capacity;
+    });
+    certificate.optimal = !reached[network.sink] and cut_capacity == flow.value;
+    return certificate;
+}
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* Goldberg and Rao's binary blocking flow algorithm, with O(min(n^{2/3}, √m)·log U) phases for
+capacities up to U, where the number of Dinitz phases doesn't depend on the capacities. It keeps an
+upper bound F on the flow left to send, and works with Δ = ⌈F/Λ⌉, Λ = min(n^{2/3}, √m): an arc is
+of length 0 if its residual capacity is at least 3Δ, or if it is at least 2Δ with a reverse arc of
+length 0 between two nodes at the same distance (a "special" arc), and of length 1 otherwise. Each
+phase computes the distances to the sink with these lengths (a 0-1 BFS), contracts the strongly
+connected components of the admissible arcs of length 0, and finds a blocking flow of at most Δ in
+the contracted network, which is acyclic, with the current arc DFS of DinitzCherkassky run in place
+on the residual network (see blocking_flow). The flow through each component is then routed inside
+it, from its nodes with an excess to a root along an in-tree of arcs of length 0, then to its nodes
+with a deficit along an out-tree: no arc carries more than 2Δ there. F decreases by the flow of each
+phase, and is set to the smallest residual capacity of the cuts between distance levels whenever
+that is lower.
+
+The blocking flow is found without dynamic trees, in O(nm) per phase as in Dinitz's algorithm, so
+the whole runs in O(min(n^{2/3}, √m)·nm·log U) rather than the O(min(n^{2/3}, √m)·m·log(n²/m)·log U)
+of the paper. The DFS isn't delegated to DinitzCherkassky, which needs a network to run on: the
+contracted network would have to be built every phase (a FlowNetwork, then its residual network),
+which cost more than the DFS itself, whereas here the components are walked through their nodes'
+lists and each component has a single current arc. */
+struct GoldbergRao
+{
+    ResidualNetwork rnetwork;
+    std::vector<flow_t> capacities; // of the input arcs, to retrieve the flow of each arc
+    std::vector<node_t> distance; // to the sink with the binary lengths
+    std::vector<node_t> component; // strongly connected component of the admissible arcs of length 0
+    std::vector<node_t> index, low, scc_stack; // of Tarjan's algorithm
+    std::vector<std::pair<node_t, arc_t>> dfs_stack; // node, position of the next arc in its list
+    std::vector<std::int64_t> imbalance; // inflow minus outflow of the phase's blocking flow
+    std::vector<ResidualArc*> in_parent, out_parent; // arcs of the trees of the components
+    std::vector<node_t> component_first, component_nodes, in_ordering, out_ordering;
+    std::vector<node_t> current_member; // position in component_nodes of the node of the current arc
+    std::vector<ResidualArc*> current_arc, path; // of each component, and of the blocking flow DFS
+    flow_t delta = 0;
+
+    static constexpr auto Unreached = std::numeric_limits<node_t>::max();
+
+    GoldbergRao(FlowNetwork const& network) : GoldbergRao(ResidualNetwork(network)) {
+        capacities = arc_capacities(network);
+    }
+
+    GoldbergRao(ResidualNetwork rnetwork) : rnetwork(std::move(rnetwork)), distance(this->rnetwork.n),
+        component(this->rnetwork.n), index(this->rnetwork.n), low(this->rnetwork.n),
+        imbalance(this->rnetwork.n, 0), in_parent(this->rnetwork.n), out_parent(this->rnetwork.n),
+        component_nodes(this->rnetwork.n), in_ordering(this->rnetwork.n), out_ordering(this->rnetwork.n),
+        current_member(this->rnetwork.n), current_arc(this->rnetwork.n) {}
+
+    node_t tail(ResidualArc const& arc) const { return arc.twin->head; }
+
+    /* The binary length of the arc, special arcs included once the distances are known. */
+    node_t length(ResidualArc const& arc, bool special = true) const {
+        if (arc.residual_capacity >= 3 * std::uint64_t{delta}) return 0;
+        if (special and arc.residual_capacity >= 2 * std::uint64_t{delta} and arc.twin->residual_capacity >= 3 * std::uint64_t{delta}
+            and distance[tail(arc)] == distance[arc.head]) return 0;
+        return 1;
+    }
+
+    bool admissible(ResidualArc const& arc) const {
+        return arc.residual_capacity != 0 and distance[arc.head] != Unreached
+            and distance[tail(arc)] == distance[arc.head] + length(arc);
+    }
+    bool zero_length(ResidualArc const& arc) const { return admissible(arc) and length(arc) == 0; }
+
+    /* Algorithm's main loop, returns the maximum flow value (the flow itself is left in rnetwork). */
+    flow_t solve() {
+        std::uint64_t source_capacity = 0, sink_capacity = 0;
+        for (auto const& arc : rnetwork.arcs_out(rnetwork.source)) source_capacity += arc.residual_capacity;
+        for (auto const& arc : rnetwork.arcs_out(rnetwork.sink)) sink_capacity += arc.twin->residual_capacity;
+        auto bound = std::min(source_capacity, sink_capacity); // F
+        auto const lambda = std::max(1.0, std::ceil(std::min(std::sqrt(rnetwork.m / 2.0), std::cbrt(double(rnetwork.n) * rnetwork.n))));
+
+        flow_t maxflow = 0;
+        while (bound > 0) {
+            delta = static_cast<flow_t>(std::min<double>(std::ceil(bound / lambda), std::numeric_limits<flow_t>::max()));
+            if (!compute_distances()) break;
+            if (auto const capacity = level_cut_capacity(); capacity < bound) { // a tighter bound, hence a smaller Δ
+                bound = capacity;
+                continue;
+            }
+            auto const df = blocking_flow();
+            maxflow += df;
+            bound -= df;
+        }
+        return maxflow;
+    }
+
+    Flow operator()() {
+        auto const maxflow = solve();
+        return {maxflow, get_flow_arcs(capacities, rnetwork)};
+    }
+
+    /* 0-1 BFS from the sink on the reverse residual arcs, returns whether the source is reached. */
+    bool compute_distances() {
+        std::ranges::fill(distance, Unreached);
+        distance[rnetwork.sink] = 0;
+        std::deque<node_t> queue{rnetwork.sink};
+        while (!queue.empty()) {
+            auto const v = queue.front();
+            queue.pop_front();
+            for (auto const& arc : rnetwork.arcs_out(v)) {
+                auto const& reverse = *arc.twin; // from the neighbor u to v
+                if (reverse.residual_capacity == 0) continue;
+                auto const l = length(reverse, false);
+                if (distance[v] + l < distance[arc.head]) {
+                    distance[arc.head] = distance[v] + l;
+                    if (l == 0) queue.push_front(arc.head);
+                    else queue.push_back(arc.head);
+                }
+            }
+        }
+        return distance[rnetwork.source] != Unreached;
+    }
+
+    /* The smallest residual capacity of the cuts {u : distance(u) ≥ i}, 0 < i ≤ distance(source). */
+    std::uint64_t level_cut_capacity() const {
+        auto const levels = distance[rnetwork.source];
+        std::vector<std::uint64_t> difference(levels + 2, 0);
+        for (auto u : rnetwork.nodes())
+            for (auto const& arc : rnetwork.arcs_out(u)) {
+                auto const du = std::min(distance[u], levels), dv = distance[arc.head];
+                if (arc.residual_capacity != 0 and dv < du) { // crosses the levels dv + 1 to du
+                    difference[dv + 1] += arc.residual_capacity;
+                    difference[du + 1] -= arc.residual_capacity;
+                }
+            }
+        auto capacity = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t level_capacity = 0;
+        for (node_t i = 1; i <= levels; ++i) capacity = std::min(capacity, level_capacity += difference[i]);
+        return capacity;
+    }
+
+    /* Tarjan's algorithm on the admissible arcs of length 0 (iterative), returns the number of
+    components, numbered in the order they are completed. */
+    node_t compute_components() {
+        std::ranges::fill(index, Unreached);
+        node_t count = 0, next_index = 0;
+        for (auto root : rnetwork.nodes()) {
+            if (distance[root] == Unreached or index[root] != Unreached) continue;
+            dfs_stack.push_back({root, 0});
+            index[root] = low[root] = next_index++;
+            scc_stack.push_back(root);
+            while (!dfs_stack.empty()) {
+                auto& [u, position] = dfs_stack.back();
+                auto const arcs = rnetwork.arcs_out(u);
+                for (; position < std::size(arcs); ++position) {
+                    auto const v = arcs[position].head;
+                    if (!zero_length(arcs[position])) continue;
+                    if (index[v] == Unreached) break;
+                    if (component[v] == Unreached) low[u] = std::min(low[u], index[v]); // still on the stack
+                }
+                if (position < std::size(arcs)) { // descends to v
+                    auto const v = arcs[position++].head;
+                    index[v] = low[v] = next_index++;
+                    scc_stack.push_back(v);
+                    dfs_stack.push_back({v, 0});
+                    continue;
+                }
+                auto const w = u;
+                dfs_stack.pop_back();
+                if (!dfs_stack.empty()) low[dfs_stack.back().first] = std::min(low[dfs_stack.back().first], low[w]);
+                if (low[w] == index[w]) {
+                    node_t x;
+                    do {
+                        x = scc_stack.back();
+                        scc_stack.pop_back();
+                        component[x] = count;
+                    } while (x != w);
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    /* Lists the nodes of each component, in component_nodes from component_first[c]. */
+    void list_components(node_t count) {
+        component_first.assign(count + 1, 0);
+        for (auto u : rnetwork.nodes()) if (distance[u] != Unreached) ++component_first[component[u] + 1];
+        for (node_t c = 0; c < count; ++c) component_first[c + 1] += component_first[c];
+        auto next = component_first;
+        for (auto u : rnetwork.nodes()) if (distance[u] != Unreached) component_nodes[next[component[u]]++] = u;
+    }
+
+    /* An admissible arc between two components, of length 1 or from a component completed after its
+    head's one by Tarjan's algorithm (the contracted network is acyclic in that order). The order also
+    rejects the reverse arcs of the arcs pushed during the phase, whose length may have dropped to 0,
+    so an arc is admissible as it was at the start of the phase when its component's current arc
+    reaches it. */
+    bool contracted_admissible(ResidualArc const& arc) const {
+        auto const u = tail(arc), v = arc.head;
+        return component[u] != component[v] and admissible(arc)
+            and (distance[v] < distance[u] or component[v] < component[u]);
+    }
+
+    /* The current arc of component c, advanced past the arcs which aren't admissible in the contracted
+    network (through the lists of all its nodes), nullptr if none is left. */
+    ResidualArc* next_arc(node_t c) {
+        while (current_member[c] < component_first[c + 1]) {
+            auto const arcs = rnetwork.arcs_out(component_nodes[current_member[c]]);
+            for (; current_arc[c] != arcs.data() + std::size(arcs); ++current_arc[c])
+                if (contracted_admissible(*current_arc[c])) return current_arc[c];
+            if (++current_member[c] < component_first[c + 1])
+                current_arc[c] = rnetwork.arcs_out(component_nodes[current_member[c]]).data();
+        }
+        return nullptr;
+    }
+
+    /* Finds a blocking flow of at most Δ in the admissible network and pushes it, returns its value.
+    As in DinitzCherkassky, with the components of the admissible arcs of length 0 contracted in
+    place: the DFS goes from component to component along admissible arcs (distances decrease along
+    them, or components in Tarjan's order), each component having a current arc which scans the lists
+    of all its nodes, and backtracks from a dead end past its entering arc. The flow entering and
+    leaving each component through different nodes is then routed inside it. */
+    flow_t blocking_flow() {
+        std::ranges::fill(component, Unreached); // also marks the nodes on Tarjan's stack
+        auto const count = compute_components();
+        list_components(count);
+
+        flow_t value = delta;
+        if (auto const target = component[rnetwork.sink]; component[rnetwork.source] != target) {
+            for (node_t c = 0; c < count; ++c) {
+                current_member[c] = component_first[c];
+                current_arc[c] = rnetwork.arcs_out(component_nodes[component_first[c]]).data();
+            }
+            value = 0;
+            path.clear();
+            for (auto c = component[rnetwork.source]; value < delta;) {
+                if (c == target) { // augments along the path, then backtracks to its first saturated arc
+                    auto df = delta - value;
+                    for (auto arc : path) df = std::min(df, arc->residual_capacity);
+                    for (auto arc : path) {
+                        arc->push_flow(df);
+                        imbalance[tail(*arc)] -= df;
+                        imbalance[arc->head] += df;
+                    }
+                    value += df;
+                    auto const saturated = std::ranges::find_if(path, &ResidualArc::is_saturated);
+                    if (saturated != end(path)) {
+                        c = component[tail(**saturated)];
+                        path.erase(saturated, end(path));
+                    }
+                } else if (auto const arc = next_arc(c)) {
+                    path.push_back(arc);
+                    c = component[arc->head];
+                } else { // a dead end, never entered again in the phase
+                    if (path.empty()) break;
+                    c = component[tail(*path.back())];
+                    path.pop_back();
+                    ++current_arc[c];
+                }
+            }
+        }
+        imbalance[rnetwork.source] += value;
+        imbalance[rnetwork.sink] -= value;
+        route_in_components(count);
+        return value;
+    }
+
+    /* Balances the nodes of each component through its root, along arcs of length 0 (which have a
+    residual capacity of at least 2Δ, and carry at most Δ in each tree). */
+    void route_in_components(node_t count) {
+        for (node_t c = 0; c < count; ++c) {
+            auto const nodes = std::span(component_nodes).subspan(component_first[c], component_first[c + 1] - component_first[c]);
+            if (std::ranges::all_of(nodes, [&](node_t u) { return imbalance[u] == 0; })) continue;
+            auto const root = nodes[0];
+
+            // both trees are built before any push, which changes the lengths
+            auto const tree = [&](std::vector<ResidualArc*>& parent, std::vector<node_t>& ordering, bool inward) {
+                for (auto u : nodes) parent[u] = nullptr;
+                ordering[0] = root;
+                auto last = begin(ordering) + 1;
+                for (auto u = begin(ordering); u != last; ++u)
+                    for (auto& arc : rnetwork.arcs_out(*u)) {
+                        auto& tree_arc = inward ? *arc.twin : arc; // from the child in an in-tree
+                        auto const v = arc.head;
+                        if (v != root and component[v] == c and !parent[v] and zero_length(tree_arc)) {
+                            parent[v] = &tree_arc;
+                            *(last++) = v;
+                        }
+                    }
+                return std::span(begin(ordering) + 1, last); // without the root
+            };
+            auto const in_tree = tree(in_parent, in_ordering, true), out_tree = tree(out_parent, out_ordering, false);
+
+            for (auto u : in_tree | std::views::reverse)
+                if (imbalance[u] > 0) {
+                    in_parent[u]->push_flow(static_cast<flow_t>(imbalance[u]));
+                    imbalance[in_parent[u]->head] += imbalance[u];
+                    imbalance[u] = 0;
+                }
+            for (auto u : out_tree | std::views::reverse)
+                if (imbalance[u] < 0) {
+                    out_parent[u]->push_flow(static_cast<flow_t>(-imbalance[u]));
+                    imbalance[tail(*out_parent[u])] += imbalance[u];
+                    imbalance[u] = 0;
+                }
+            imbalance[root] = 0;
+        }
+    }
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* An append-only array stored in fixed size blocks: growing it never moves (nor copies) what is
+already stored, and the blocks can be released one by one once consumed. */
+template <typename T, size_t BlockSize = size_t{1} << 16>
+struct BlockArray
+{
+    std::vector<std::unique_ptr<T[]>> blocks;
+    size_t count = 0;
+
+    size_t size() const { return count; }
+    T& operator[](size_t i) { return blocks[i / BlockSize][i % BlockSize]; }
+    T const& operator[](size_t i) const { return blocks[i / BlockSize][i % BlockSize]; }
+    void push_back(T const& value) {
+        if (count % BlockSize == 0) blocks.push_back(std::make_unique<T[]>(BlockSize));
+        blocks[count / BlockSize][count % BlockSize] = value;
+        ++count;
+    }
+    /* Calls f on each element in order, releasing each block once it has been visited. */
+    template <typename F>
+    void consume(F&& f) {
+        for (size_t i = 0; i < count; ++i) {
+            f(blocks[i / BlockSize][i % BlockSize]);
+            if ((i + 1) % BlockSize == 0 or i + 1 == count) blocks[i / BlockSize].reset();
+        }
+        blocks.clear();
+        count = 0;
+    }
+};
+
+
+/* Builds a flow network incrementally, the way vision codes build their graphs (as with Boykov and
+Kolmogorov's library): nodes are added, then edges with a capacity in each direction and terminal
+weights, i.e. capacities from the source and to the sink, which accumulate. The source and the sink
+are implicit, they are numbered after the added nodes. Edges and weights are kept in BlockArray, with
+no bound to declare beforehand, and build() turns them directly into a ResidualNetwork, an edge being
+a pair of residual arcs (without merging it with other edges between the same nodes).
+
+The input arcs of the built network, whose flow get_flow_arcs returns from capacities(), are the
+arcs (u, v) and (v, u) of each edge in order, then the arcs (source, u) and (u, sink) of each node. */
+struct GraphBuilder
+{
+    struct Edge { node_t u, v; flow_t capacity, reverse_capacity; };
+    struct TerminalWeights { flow_t source, sink; };
+
+    BlockArray<Edge> edges;
+    BlockArray<TerminalWeights> weights; // of each node
+
+    size_t node_count() const { return weights.size(); }
+    size_t edge_count() const { return edges.size(); }
+    node_t source() const { return static_cast<node_t>(node_count()); }
+    node_t sink() const { return static_cast<node_t>(node_count() + 1); }
+
+    /* Adds count nodes, returns the first of them. */
+    node_t add_node(size_t count = 1) {
+        auto const first = static_cast<node_t>(node_count());
+        for (size_t i = 0; i < count; ++i) weights.push_back({0, 0});
+        return first;
+    }
+
+    void add_edge(node_t u, node_t v, flow_t capacity, flow_t reverse_capacity) {
+        if (u >= node_count() or v >= node_count() or u == v)
+            throw std::invalid_argument("Invalid edge: unknown node or loop.");
+        edges.push_back({u, v, capacity, reverse_capacity});
+    }
+
+    void add_terminal_weights(node_t u, flow_t source_capacity, flow_t sink_capacity) {
+        if (u >= node_count()) throw std::invalid_argument("Invalid terminal weights: unknown node.");
+        weights[u].source += source_capacity;
+        weights[u].sink += sink_capacity;
+    }
+
+    /* The capacities of the input arcs (see above), to retrieve their flow after the solve. */
+    std::vector<flow_t> capacities() const {
+        std::vector<flow_t> capacities;
+        capacities.reserve(2 * (edge_count() + node_count()));
+        for (size_t e = 0; e < edge_count(); ++e) {
+            capacities.push_back(edges[e].capacity);
+            capacities.push_back(edges[e].reverse_capacity);
+        }
+        for (size_t u = 0; u < node_count(); ++u) {
+            capacities.push_back(weights[u].source);
+            capacities.push_back(weights[u].sink);
+        }
+        return capacities;
+    }
+
+    /* The same network as a list of arcs (see above), e.g. to check a flow with verify_flow. */
+    FlowNetwork flow_network() const {
+        FlowNetwork network{.n = node_count() + 2, .m = 0, .source = source(), .sink = sink(), .arcs = {}};
+        network.arcs.reserve(2 * (edge_count() + node_count()));
+        for (size_t e = 0; e < edge_count(); ++e) {
+            auto const& [u, v, capacity, reverse_capacity] = edges[e];
+            network.arcs.push_back({u, v, capacity});
+            network.arcs.push_back({v, u, reverse_capacity});
+        }
+        for (size_t u = 0; u < node_count(); ++u) {
+            network.arcs.push_back({source(), static_cast<node_t>(u), weights[u].source});
+            network.arcs.push_back({static_cast<node_t>(u), sink(), weights[u].sink});
+        }
+        network.m = std::size(network.arcs);
+        return network;
+    }
+
+    /* Builds the residual network, releasing the blocks as they are consumed (the builder is left
+    empty). A terminal arc of capacity 0 gets no residual arc, its input arc is then mapped to
+    ResidualNetwork::NoArc (get_flow_arcs gives it no flow). */
+    ResidualNetwork build() && {
+        auto const n = node_count() + 2;
+        ResidualNetwork rnetwork(n, source(), sink());
+
+        std::vector<node_t> degree_out(n, 0);
+        for (size_t e = 0; e < edge_count(); ++e) { ++degree_out[edges[e].u]; ++degree_out[edges[e].v]; }
+        for (size_t u = 0; u < node_count(); ++u) {
+            if (weights[u].source != 0) { ++degree_out[u]; ++degree_out[source()]; }
+            if (weights[u].sink != 0) { ++degree_out[u]; ++degree_out[sink()]; }
+        }
+        for (auto d : degree_out) rnetwork.m += d;
+        rnetwork.adjlist.resize(rnetwork.m);
+        rnetwork.original_arc.assign(2 * (edge_count() + node_count()), ResidualNetwork::NoArc);
+
+        std::vector<decltype(rnetwork.adjlist)::iterator> adjlist_iter(n + 1);
+        adjlist_iter[0] = begin(rnetwork.adjlist);
+        for (auto u : rnetwork.nodes()) {
+            adjlist_iter[u + 1] = adjlist_iter[u] + degree_out[u];
+            rnetwork.arcs_out_span[u] = std::span(adjlist_iter[u], adjlist_iter[u + 1]);
+        }
+
+        size_t a = 0; // the next input arc
+        auto const add_pair = [&](node_t u, node_t v, flow_t capacity, flow_t reverse_capacity) {
+            *adjlist_iter[u] = {v, capacity, &*adjlist_iter[v]};
+            *adjlist_iter[v] = {u, reverse_capacity, &*adjlist_iter[u]};
+            return static_cast<arc_t>(adjlist_iter[u]++ - begin(rnetwork.adjlist));
+        };
+        edges.consume([&](Edge const& edge) {
+            rnetwork.original_arc[a] = add_pair(edge.u, edge.v, edge.capacity, edge.reverse_capacity);
+            rnetwork.original_arc[a + 1] = static_cast<arc_t>(adjlist_iter[edge.v]++ - begin(rnetwork.adjlist));
+            a += 2;
+        });
+        node_t node = 0;
+        weights.consume([&, source = source(), sink = sink()](TerminalWeights const& weight) {
+            if (weight.source != 0) {
+                rnetwork.original_arc[a] = add_pair(source, node, weight.source, 0);
+                ++adjlist_iter[node];
+            }
+            if (weight.sink != 0) {
+                rnetwork.original_arc[a + 1] = add_pair(node, sink, weight.sink, 0);
+                ++adjlist_iter[sink];
+            }
+            a += 2;
+            ++node;
+        });
+        return rnetwork;
+    }
+};
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* Excesses incremental breadth-first search (EIBFS) of Goldberg, Hed, Kaplan, Kohli, Tarjan and
+Werneck, tuned for the vision instances. Like Boykov and Kolmogorov's algorithm, it grows a source
+tree S and a sink tree T, and augments along the paths they form when they touch, but the trees are
+kept breadth-first: label(v) is the distance from the root of v's tree in S (resp. to it in T). The
+trees grow one level at a time, alternately, the side with the smaller front first.
+
+EIBFS maintains a pseudoflow rather than a flow: the roots of S are the source and the nodes with an
+excess (more inflow than outflow), the roots of T the sink and the nodes with a deficit. An augmenta-
+tion pushes as much flow on the bridge arc (v, w) between the trees as their roots can supply and
+take, whatever the capacities of the tree paths: the deficit it leaves at v is pulled up v's tree
+towards its root, and the excess at w pushed down towards its root, as far as the tree arcs allow.
+A saturated tree arc leaves an orphan, which keeps what couldn't go further. An orphan is adopted by
+a neighbor of the level right below it if possible (from its current arc), or else relabeled to the
+lowest level it can hang on, and then passes its excess or deficit on; if it can't hang on its tree
+anymore, its children become orphans, and it becomes a root of the other tree if it has an excess
+(in T) or a deficit (in S), or is freed.
+
+The trees stop growing when a cut is saturated, the remaining excesses are then returned to the
+source and the deficits made up from the sink (see cancel_excesses). O(n²m) in the worst case, much
+less on the grids. */
+struct IncrementalBFS
+{
+    enum class Side : std::uint8_t { Free, Source, Sink };
+
+    ResidualNetwork rnetwork;
+    std::vector<flow_t> capacities; // of the input arcs, to retrieve the flow of each arc
+    std::vector<Side> side;
+    std::vector<node_t> label; // in the trees, then the distance label of cancel_excesses
+    std::vector<ResidualArc*> parent; // arc to the parent in the node's list, null for the roots and orphans
+    std::vector<arc_t> current_arc; // position in the node's list of its parent or of the next candidate
+    std::vector<std::int64_t> excess; // inflow minus outflow, of the terminals and the roots
+    std::vector<node_t> source_front, sink_front, next_front; // the unscanned nodes of the last levels
+    std::vector<node_t> orphans;
+    node_t source_level = 0, sink_level = 0; // of the fronts
+    Side growing = Side::Source;
+
+    static constexpr auto Unreached = std::numeric_limits<node_t>::max();
+
+    IncrementalBFS(FlowNetwork const& network) : IncrementalBFS(ResidualNetwork(network)) {
+        capacities = arc_capacities(network);
+    }
+
+    IncrementalBFS(ResidualNetwork rnetwork) : rnetwork(std::move(rnetwork)), side(this->rnetwork.n, Side::Free),
+        label(this->rnetwork.n, 0), parent(this->rnetwork.n, nullptr), current_arc(this->rnetwork.n, 0),
+        excess(this->rnetwork.n, 0) {}
+
+    /* The residual capacity of the tree arc between node v and the neighbor at the other end of arc
+    (taken from v's list), if that neighbor is v's parent in the tree of the given side. */
+    static flow_t tree_capacity(Side tree, ResidualArc const& arc) {
+        return tree == Side::Source ? arc.twin->residual_capacity : arc.residual_capacity;
+    }
+    arc_t position(node_t v, ResidualArc const* arc) const {
+        return static_cast<arc_t>(arc - rnetwork.arcs_out(v).data());
+    }
+    static Side other(Side tree) { return tree == Side::Source ? Side::Sink : Side::Source; }
+
+    /* The flow that v must pass to its parent in the given tree: its deficit in S, its excess in T. */
+    std::int64_t surplus(Side tree, node_t v) const { return tree == Side::Source ? -excess[v] : excess[v]; }
+    bool is_root(node_t v) const {
+        return v == rnetwork.source or v == rnetwork.sink or surplus(side[v], v) < 0;
+    }
+
+    /* Algorithm's main loop, returns the maximum flow value (the flow itself is left in rnetwork). */
+    flow_t solve() {
+        side[rnetwork.source] = Side::Source;
+        side[rnetwork.sink] = Side::Sink;
+        source_front = {rnetwork.source};
+        sink_front = {rnetwork.sink};
+        while (!source_front.empty() and !sink_front.empty())
+            grow(std::size(source_front) <= std::size(sink_front) ? Side::Source : Side::Sink);
+        cancel_excesses();
+        return static_cast<flow_t>(excess[rnetwork.sink]);
+    }
+
+    Flow operator()() {
+        auto const maxflow = solve();
+        return {maxflow, get_flow_arcs(capacities, rnetwork)};
+    }
+
+    /* Scans the front of the given tree: its free neighbors join the tree on the next level, and the
+    arcs reaching the other tree are augmented. */
+    void grow(Side tree) {
+        growing = tree;
+        auto& front = tree == Side::Source ? source_front : sink_front;
+        auto& level = tree == Side::Source ? source_level : sink_level;
+        next_front.clear();
+        for (size_t i = 0; i < std::size(front); ++i) { // relabeled orphans and new roots may join the front meanwhile
+            auto const v = front[i];
+            for (auto& arc : rnetwork.arcs_out(v)) {
+                if (side[v] != tree or label[v] != level) break; // relabeled or moved by an augmentation
+                auto const w = arc.head;
+                while (side[w] != tree and tree_capacity(tree, *arc.twin) != 0) {
+                    if (side[w] == Side::Free) {
+                        side[w] = tree;
+                        label[w] = level + 1;
+                        parent[w] = arc.twin;
+                        current_arc[w] = position(w, arc.twin);
+                        next_front.push_back(w);
+                        break;
+                    }
+                    augment(tree == Side::Source ? arc : *arc.twin);
+                    if (side[v] != tree or label[v] != level) break;
+                }
+            }
+        }
+        ++level;
+        std::swap(front, next_front);
+    }
+
+    /* Pushes as much flow on the bridge arc from S to T as the roots of both trees can supply (resp.
+    take), passes the deficit and the excess it leaves towards them, and adopts the orphans left by the
+    saturated tree arcs. */
+    void augment(ResidualArc& bridge) {
+        auto const v = bridge.twin->head, w = bridge.head;
+        auto delta = std::int64_t{bridge.residual_capacity};
+        for (auto [u, tree] : {std::pair(v, Side::Source), std::pair(w, Side::Sink)}) {
+            while (parent[u]) u = parent[u]->head;
+            if (u != rnetwork.source and u != rnetwork.sink) delta = std::min(delta, -surplus(tree, u));
+        }
+        bridge.push_flow(static_cast<flow_t>(delta));
+        excess[v] -= delta;
+        excess[w] += delta;
+        pass_to_root(v);
+        pass_to_root(w);
+        for (size_t i = 0; i < std::size(orphans); ++i) { // may add orphans
+            auto const u = orphans[i];
+            if (side[u] != Side::Free and !parent[u] and !is_root(u)) adopt(u);
+        }
+        orphans.clear();
+    }
+
+    /* Passes the surplus of v to its parent, and so on up to a root, as far as the tree arcs allow: a
+    node whose tree arc gets saturated becomes an orphan with what is left, as does a root whose
+    excess (in S) or deficit (in T) gets used up. */
+    void pass_to_root(node_t v) {
+        auto const tree = side[v];
+        while (surplus(tree, v) > 0 and !is_root(v) and parent[v]) {
+            auto& arc = *parent[v];
+            auto const p = arc.head;
+            auto const flow = static_cast<flow_t>(std::min<std::int64_t>(surplus(tree, v), tree_capacity(tree, arc)));
+            if (tree == Side::Source) {
+                arc.twin->push_flow(flow);
+                excess[v] += flow;
+                excess[p] -= flow;
+            } else {
+                arc.push_flow(flow);
+                excess[v] -= flow;
+                excess[p] += flow;
+            }
+            if (tree_capacity(tree, arc) == 0) {
+                parent[v] = nullptr;
+                orphans.push_back(v);
+            }
+            v = p;
+        }
+        if (!parent[v] and !is_root(v)) orphans.push_back(v);
+    }
+
+    void adopt(node_t v) {
+        auto const tree = side[v];
+        auto const arcs = rnetwork.arcs_out(v);
+        // a new parent on the level right below, from the current arc on
+        for (auto j = current_arc[v]; j < std::size(arcs); ++j) {
+            auto& arc = arcs[j];
+            if (side[arc.head] == tree and label[arc.head] + 1 == label[v] and tree_capacity(tree, arc) != 0) {
+                parent[v] = &arc;
+                current_arc[v] = j;
+                pass_to_root(v);
+                return;
+            }
+        }
+
+        // or the lowest possible level, unless it is beyond the front (the growth will reach v then)
+        auto best = Unreached;
+        for (arc_t j = 0; j < std::size(arcs); ++j) {
+            auto const& arc = arcs[j];
+            if (side[arc.head] == tree and label[arc.head] < best and tree_capacity(tree, arc) != 0) {
+                best = label[arc.head];
+                current_arc[v] = j;
+            }
+        }
+        auto const front_level = tree == Side::Source ? source_level : sink_level;
+        auto const last_level = front_level + (growing == tree ? 1 : 0);
+        auto const old_label = label[v];
+        if (best == Unreached or best + 1 > last_level) {
+            if (surplus(tree, v) > 0) join_as_root(other(tree), v);
+            else side[v] = Side::Free;
+        } else {
+            label[v] = best + 1;
+            parent[v] = &arcs[current_arc[v]];
+            if (label[v] == front_level) (tree == Side::Source ? source_front : sink_front).push_back(v);
+            else if (label[v] > front_level) next_front.push_back(v);
+        }
+        if (side[v] == tree and label[v] == old_label) return pass_to_root(v);
+        for (auto& arc : arcs) // the children lose their level
+            if (side[arc.head] == tree and parent[arc.head] == arc.twin) {
+                parent[arc.head] = nullptr;
+                orphans.push_back(arc.head);
+            }
+        if (side[v] == tree) pass_to_root(v);
+    }
+
+    /* Makes v, with an excess (resp. a deficit), a root of S (resp. T) on the level of its front, which
+    keeps the levels of the neighbors in the tree at most one above v's. */
+    void join_as_root(Side tree, node_t v) {
+        side[v] = tree;
+        parent[v] = nullptr;
+        current_arc[v] = 0;
+        label[v] = tree == Side::Source ? source_level : sink_level;
+        (tree == Side::Source ? source_front : sink_front).push_back(v);
+    }
+
+    /* Turns the pseudoflow left when the trees stop growing into a flow of the same value: no residual
+    path crosses the cut they saturated, so the excesses go back to the source and the deficits are
+    made up from the sink, each within its side. As in push-relabel, the pending nodes are discharged
+    in FIFO order to the neighbors one label closer to the terminal, label being a lower bound on the
+    distance to the source (resp. from the sink), so only the region around them is scanned. */
+    void cancel_excesses() {
+        for (auto const to_source : {true, false}) {
+            auto const terminal = to_source ? rnetwork.source : rnetwork.sink;
+            std::ranges::fill(label, 1); // a valid labeling, raised as the discharges need it
+            label[terminal] = 0;
+            std::ranges::fill(current_arc, 0);
+            next_front.clear();
+            for (auto v : rnetwork.nodes()) if (pending(to_source, v)) next_front.push_back(v);
+            for (size_t i = 0; i < std::size(next_front); ++i) discharge(next_front[i], to_source);
+        }
+        next_front.clear();
+    }
+
+    /* Whether v has an excess left to return to the source (resp. a deficit to make up from the sink). */
+    bool pending(bool to_source, node_t v) const {
+        return v != rnetwork.source and v != rnetwork.sink and (to_source ? excess[v] > 0 : excess[v] < 0);
+    }
+
+    /* The residual capacity of an arc of v's list in the direction of the flow sent back to the source
+    (from v to the neighbor), resp. from the sink (from the neighbor to v). */
+    static flow_t flow_capacity(bool to_source, ResidualArc const& arc) {
+        return to_source ? arc.residual_capacity : arc.twin->residual_capacity;
+    }
+
+    /* Sends the excess (resp. deficit) of v to its neighbors one label closer to the terminal from the
+    current arc on, relabels v when the list is exhausted, until v is balanced. The neighbors left
+    pending join the queue in next_front. */
+    void discharge(node_t v, bool to_source) {
+        auto const arcs = rnetwork.arcs_out(v);
+        while (pending(to_source, v)) {
+            if (current_arc[v] == std::size(arcs)) {
+                auto lowest = Unreached;
+                for (auto const& arc : arcs)
+                    if (flow_capacity(to_source, arc) != 0) lowest = std::min(lowest, label[arc.head]);
+                if (lowest >= rnetwork.n) throw std::logic_error("An excess can't be cancelled.");
+                label[v] = lowest + 1;
+                current_arc[v] = 0;
+            }
+            auto& arc = arcs[current_arc[v]];
+            auto const w = arc.head;
+            if (label[w] + 1 != label[v] or flow_capacity(to_source, arc) == 0) {
+                ++current_arc[v];
+                continue;
+            }
+            auto const df = static_cast<flow_t>(std::min<std::int64_t>(to_source ? excess[v] : -excess[v], flow_capacity(to_source, arc)));
+            auto const was_pending = pending(to_source, w);
+            (to_source ? arc : *arc.twin).push_flow(df);
+            excess[v] += to_source ? -std::int64_t{df} : std::int64_t{df};
+            excess[w] += to_source ? std::int64_t{df} : -std::int64_t{df};
+            if (!was_pending and pending(to_source, w)) next_front.push_back(w);
+        }
+    }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "maxflow.hpp"
+#include "graph_builder.hpp"
+
+
+/* Walks a width × height 4-connected grid, as the BVZ segmentation instances: calls add_pixel(p,
+source_capacity, sink_capacity) on each pixel p (random data capacities), and add_edge(p, q, capacity)
+on each pair of neighbors (random smoothness capacity, the same in both directions). The pixels are
+numbered row by row from first_pixel on, unless shuffled: then they get random numbers, as a badly
+ordered input would (see bfs_node_order to repair it). Deterministic for a given seed. */
+template <typename AddPixel, typename AddEdge>
+void generate_grid(size_t width, size_t height, std::uint64_t seed, bool shuffled, node_t first_pixel,
+    AddPixel&& add_pixel, AddEdge&& add_edge)
+{
+    std::mt19937_64 random(seed);
+    auto const capacity = [&](flow_t max) { return static_cast<flow_t>(std::uniform_int_distribution<flow_t>(0, max)(random)); };
+
+    std::vector<node_t> pixel(width * height);
+    std::iota(begin(pixel), end(pixel), first_pixel);
+    if (shuffled) std::ranges::shuffle(pixel, random);
+
+    for (size_t y = 0; y < height; ++y)
+        for (size_t x = 0; x < width; ++x) {
+            auto const p = pixel[y * width + x];
+            auto const source_capacity = capacity(100);
+            add_pixel(p, source_capacity, capacity(100));
+            if (x + 1 < width) add_edge(p, pixel[y * width + x + 1], capacity(40));
+            if (y + 1 < height) add_edge(p, pixel[(y + 1) * width + x], capacity(40));
+        }
+}
+
+
+/* The grid above as a flow network: the source is node 0, the sink node 1, the pixels follow. */
+inline FlowNetwork generate_grid_network(size_t width, size_t height, std::uint64_t seed = 1, bool shuffled = false)
+{
+    FlowNetwork network{.n = width * height + 2, .m = 0, .source = 0, .sink = 1, .arcs = {}};
+    network.arcs.reserve(6 * width * height);
+    generate_grid(width, height, seed, shuffled, node_t{2}, [&](node_t p, flow_t source_capacity, flow_t sink_capacity) {
+        network.arcs.push_back({network.source, p, source_capacity});
+        network.arcs.push_back({p, network.sink, sink_capacity});
+    }, [&](node_t p, node_t q, flow_t capacity) {
+        network.arcs.push_back({p, q, capacity});
+        network.arcs.push_back({q, p, capacity});
+    });
+    network.m = std::size(network.arcs);
+    return network;
+}
+
+
+/* The same grid given to a GraphBuilder, which numbers the pixels from 0 (the terminals come last). */
+inline GraphBuilder generate_grid_builder(size_t width, size_t height, std::uint64_t seed = 1, bool shuffled = false)
+{
+    GraphBuilder builder;
+    builder.add_node(width * height);
+    generate_grid(width, height, seed, shuffled, node_t{0}, [&](node_t p, flow_t source_capacity, flow_t sink_capacity) {
+        builder.add_terminal_weights(p, source_capacity, sink_capacity);
+    }, [&](node_t p, node_t q, flow_t capacity) {
+        builder.add_edge(p, q, capacity, capacity);
+    });
+    return builder;
+}
+
+
+/* A random network of n nodes and m arcs between uniformly drawn distinct nodes, with capacities
+drawn uniformly in [1, max_capacity]: with large capacities, the number of phases of the algorithms
+whose bounds depend on log U shows (see goldberg_rao.hpp). The source is node 0, the sink node n - 1.
+Deterministic for a given seed. */
+inline FlowNetwork generate_random_network(size_t n, size_t m, flow_t max_capacity, std::uint64_t seed = 1)
+{
+    if (n < 2) throw std::invalid_argument("A random network needs at least 2 nodes.");
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<node_t> node(0, static_cast<node_t>(n - 1));
+    std::uniform_int_distribution<flow_t> capacity(1, max_capacity);
+    FlowNetwork network{.n = n, .m = m, .source = 0, .sink = static_cast<node_t>(n - 1), .arcs = {}};
+    network.arcs.reserve(m);
+    while (std::size(network.arcs) < m) {
+        auto const u = node(random), v = node(random);
+        if (u != v) network.arcs.push_back({u, v, capacity(random)});
+    }
+    return network;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "maxflow.hpp"
+#include "parallel.hpp"
+
+
+/* Finalizer of the SplitMix64 generator, used as a cheap but well mixing 64 bits hash function. */
+constexpr std::uint64_t mix64(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+
+/* Content hash of a flow network, with a checksum of its arcs computed independently of it, which
+tells apart two networks whose hashes collide. */
+struct NetworkDigest
+{
+    std::uint64_t hash, checksum;
+};
+
+
+/* Computes the digest of the flow network: the hash covers the number of nodes and arcs, the
+terminals, and the arcs in their order (the arcs order matters since Flow::flow_arcs is indexed by
+it), the checksum is a sum over the arcs of a different mix of each arc with its index. The arcs are
+digested by blocks of fixed size in parallel, then the block hashes are folded sequentially, so that
+the result doesn't depend on the number of threads. */
+inline NetworkDigest digest_flow_network(FlowNetwork const& network)
+{
+    constexpr size_t BlockSize = 1 << 16;
+    std::vector<NetworkDigest> block_digest((std::size(network.arcs) + BlockSize - 1) / BlockSize);
+
+    parallel_for(std::size(block_digest), [&](size_t first_block, size_t last_block) {
+        for (auto block = first_block; block != last_block; ++block) {
+            std::uint64_t h = mix64(block), checksum = 0;
+            auto const last = std::min(std::size(network.arcs), (block + 1) * BlockSize);
+            for (auto a = block * BlockSize; a != last; ++a) {
+                auto const& [u, v, capacity] = network.arcs[a];
+                h = mix64(h ^ (std::uint64_t{u} << 32 | v));
+                h = mix64(h ^ capacity);
+                checksum += mix64((std::uint64_t{v} << 32 | u) + (std::uint64_t{capacity} << 16) + a * 0x9e3779b97f4a7c15);
+            }
+            block_digest[block] = {h, checksum};
+        }
+    }, 1);
+
+    NetworkDigest digest{mix64(network.n), 0};
+    digest.hash = mix64(digest.hash ^ network.m);
+    digest.hash = mix64(digest.hash ^ (std::uint64_t{network.source} << 32 | network.sink));
+    for (auto [bh, checksum] : block_digest) {
+        digest.hash = mix64(digest.hash ^ bh);
+        digest.checksum += checksum;
+    }
+    return digest;
+}
+
+inline std::uint64_t hash_flow_network(FlowNetwork const& network) { return digest_flow_network(network).hash; }
@@ -6,8 +6,11 @@
 #include "maxflow.hpp"
 
 
-FlowNetwork read_maxflow_instance(std::string_view filepath) {
-    FlowNetwork instance;
+/* Parses a DIMACS maximum flow instance without storing its arcs: the sizes and terminals are set in
+the given instance and on_arc is called on each arc in the file order. It lets the arcs be streamed
+into another data structure, e.g. one which doesn't fit in memory. */
+template <typename OnArc>
+void scan_maxflow_instance(std::string_view filepath, FlowNetwork& instance, OnArc&& on_arc) {
     std::ifstream file;
     file.open(filepath.data());
 
@@ -17,7 +20,6 @@ FlowNetwork read_maxflow_instance(std::string_view filepath) {
             case 'p':
                 input.ignore(6);
                 input >> instance.n >> instance.m;
-                instance.arcs.reserve(instance.m);
                 break;
             case 'n':
                 input.ignore(2);
@@ -31,7 +33,7 @@ FlowNetwork read_maxflow_instance(std::string_view filepath) {
                 CapacityArc arc;
                 input >> arc.tail >> arc.head >> arc.capacity;
                 --arc.tail; --arc.head;
-                instance.arcs.push_back(std::move(arc));
+                on_arc(arc);
                 break;
             default:
                 break;
@@ -39,11 +41,20 @@ FlowNetwork read_maxflow_instance(std::string_view filepath) {
     }
 
     file.close();
+}
+
+
+inline FlowNetwork read_maxflow_instance(std::string_view filepath) {
+    FlowNetwork instance;
+    scan_maxflow_instance(filepath, instance, [&](CapacityArc const& arc) {
+        if (instance.arcs.empty()) instance.arcs.reserve(instance.m);
+        instance.arcs.push_back(arc);
+    });
     return instance;
 }
 
 
-flow_t read_maxflow_instance_solution(std::string_view filepath) {
+inline flow_t read_maxflow_instance_solution(std::string_view filepath) {
     flow_t maxflow = 0;
     std::ifstream file;
     file.open(filepath.data());
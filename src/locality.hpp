@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <vector>
+#include "maxflow.hpp"
+#include "parallel.hpp"
+
+
+/* The order of the arcs in each adjacency list: as built from the input, by head node (so that the
+scans of rank[head] or label[head] walk memory monotonically), or with the arcs to the sink first
+(then by head), which the DFS of the augmenting path algorithms tries first. */
+enum class ArcOrder
+{
+    Input,
+    Head,
+    SinkFirst,
+};
+
+
+/* Reorders the arcs of each adjacency list of the residual network, fixing the twin pointers and the
+positions of the input arcs (see ResidualNetwork::original_arc), so the flow is still retrieved with
+get_flow_arcs. The lists are sorted in parallel, then the arcs are moved to a new array. */
+inline void sort_adjacency_lists(ResidualNetwork& rnetwork, ArcOrder order)
+{
+    if (order == ArcOrder::Input) return;
+    auto const index = [&](ResidualArc const* arc) { return static_cast<arc_t>(arc - rnetwork.adjlist.data()); };
+    auto const key = [&](arc_t a) {
+        auto const head = rnetwork.adjlist[a].head;
+        return std::tuple(order == ArcOrder::SinkFirst and head != rnetwork.sink, head);
+    };
+
+    std::vector<arc_t> position(rnetwork.m); // new position of each arc
+    parallel_for(rnetwork.n, [&](size_t first, size_t last) {
+        std::vector<arc_t> arcs;
+        for (auto u = first; u < last; ++u) {
+            auto const first_arc = index(rnetwork.arcs_out_span[u].data());
+            arcs.resize(rnetwork.degree_out(u));
+            std::iota(begin(arcs), end(arcs), first_arc);
+            std::ranges::stable_sort(arcs, {}, key);
+            for (arc_t i = 0; i < std::size(arcs); ++i) position[arcs[i]] = first_arc + i;
+        }
+    }, 1 << 12);
+
+    decltype(rnetwork.adjlist) adjlist(rnetwork.m);
+    parallel_for(rnetwork.m, [&](size_t first, size_t last) {
+        for (auto a = first; a < last; ++a) {
+            auto const& arc = rnetwork.adjlist[a];
+            adjlist[position[a]] = {arc.head, arc.residual_capacity, &adjlist[position[index(arc.twin)]]};
+        }
+    });
+    for (auto& a : rnetwork.original_arc) if (a != ResidualNetwork::NoArc) a = position[a];
+    for (auto u : rnetwork.nodes()) {
+        auto const first_arc = index(rnetwork.arcs_out_span[u].data());
+        rnetwork.arcs_out_span[u] = std::span(adjlist).subspan(first_arc, rnetwork.degree_out(u));
+    }
+    rnetwork.adjlist = std::move(adjlist); // the buffer is moved, so the spans and twins stay valid
+}
+
+
+/* A renumbering of the nodes for locality, new_id[u] being the new number of node u: the nodes are
+numbered in the order of a BFS on the arcs taken in both directions (as in Cuthill and McKee's band-
+width reduction), so the neighbors of a node get close numbers, and their adjacency lists close
+positions. The terminals are left out of the BFS, they are linked to most nodes in the segmentation
+instances, and are numbered last. Each connected component starts from its smallest node. */
+inline std::vector<node_t> bfs_node_order(FlowNetwork const& network)
+{
+    auto const is_terminal = [&](node_t u) { return u == network.source or u == network.sink; };
+    std::vector<arc_t> first_out(network.n + 1, 0);
+    for (auto const& [u, v, capacity] : network.arcs)
+        if (!is_terminal(u) and !is_terminal(v)) { ++first_out[u + 1]; ++first_out[v + 1]; }
+    for (size_t u = 0; u < network.n; ++u) first_out[u + 1] += first_out[u];
+    std::vector<node_t> neighbors(first_out.back());
+    std::vector<arc_t> cursor(begin(first_out), end(first_out) - 1);
+    for (auto const& [u, v, capacity] : network.arcs)
+        if (!is_terminal(u) and !is_terminal(v)) { neighbors[cursor[u]++] = v; neighbors[cursor[v]++] = u; }
+
+    constexpr auto Unnumbered = std::numeric_limits<node_t>::max();
+    std::vector<node_t> new_id(network.n, Unnumbered), bfs_ordering(network.n);
+    auto last = begin(bfs_ordering);
+    for (node_t root = 0; root < network.n; ++root) {
+        if (new_id[root] != Unnumbered or is_terminal(root)) continue;
+        new_id[root] = static_cast<node_t>(last - begin(bfs_ordering));
+        *(last++) = root;
+        for (auto u = last - 1; u != last; ++u)
+            for (auto i = first_out[*u]; i < first_out[*u + 1]; ++i)
+                if (new_id[neighbors[i]] == Unnumbered) {
+                    new_id[neighbors[i]] = static_cast<node_t>(last - begin(bfs_ordering));
+                    *(last++) = neighbors[i];
+                }
+    }
+    for (auto terminal : {network.source, network.sink})
+        if (new_id[terminal] == Unnumbered) new_id[terminal] = static_cast<node_t>(last++ - begin(bfs_ordering));
+    return new_id;
+}
+
+
+/* Renames the nodes of the network, the arcs keep their indices so a flow of the renumbered network
+is a flow of the original one. */
+inline void renumber_nodes(FlowNetwork& network, std::vector<node_t> const& new_id)
+{
+    for (auto& arc : network.arcs) {
+        arc.tail = new_id[arc.tail];
+        arc.head = new_id[arc.head];
+    }
+    network.source = new_id[network.source];
+    network.sink = new_id[network.sink];
+}
@@ -1,8 +1,36 @@
 
 #include <iostream>
 #include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
 #include "maxflow.hpp"
 #include "instance_reader.hpp"
+#include "instance_hash.hpp"
+#include "flow_cache.hpp"
+#include "flow_verifier.hpp"
+#include "solution_writer.hpp"
+#include "memory_usage.hpp"
+#include "out_of_core.hpp"
+#include "multiprocess_push_relabel.hpp"
+#include "bipartite_matching.hpp"
+#include "unit_capacity.hpp"
+#include "paired_residual_network.hpp"
+#include "compressed_residual_network.hpp"
+#include "locality.hpp"
+#include "instance_generator.hpp"
+#include "perf_counter.hpp"
+#include "alpha_expansion.hpp"
+#include "shared_topology.hpp"
+#include "incremental_bfs.hpp"
+#include "async_push_relabel.hpp"
+#include "dual_decomposition.hpp"
+#include "goldberg_rao.hpp"
+#include "maxflow_c.h"
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 
 struct Timer {
@@ -34,24 +62,443 @@ auto minimal_example()
 }
 
 
-int main(int argc, char* argv[])
+/* Runs and times the given maximum flow algorithm on the network, reports its peak memory against
+the predicted one and its cache misses (if the hardware counters are available), then checks its
+output. */
+template <typename Solve>
+void benchmark(char const* name, Solver solver, FlowNetwork const& network, Solve&& solve)
 {
-    // minimal_example();
+    std::cout << "\nAlgorithm: \"" << name << "\"\n";
+    bool const peak_reset = reset_peak_rss();
+    Flow flow;
+    std::optional<std::uint64_t> cache_misses;
+    {
+        Timer t;
+        PerfCounter counter;
+        flow = solve(network);
+        cache_misses = counter.value();
+        std::cout << "Maximum flow value: " << flow.value << '\n';
+    }
+    auto const predicted = estimate_memory(network.n, network.m, solver).peak();
+    std::cout << "Peak memory: " << (peak_reset ? peak_rss() >> 20 : 0) << "MB (predicted "
+              << (predicted >> 20) << "MB + the process baseline)\n";
+    std::cout << "Cache misses: ";
+    if (cache_misses) std::cout << *cache_misses << '\n';
+    else std::cout << "n/a\n";
+    std::cout << "Certificate: " << (verify_flow(network, flow) ? "valid" : "INVALID") << '\n';
+}
 
-    if (argc != 2) throw std::runtime_error("No input file.");
 
-    auto network = read_maxflow_instance(argv[1]);
-    std::cout << "\nNetwork instance: \"" << argv[1] << " - |V| = " << network.n << ", |E| = " << network.m << '\n';
+/* The size of the synthetic grid given as "grid:<width>x<height>", none for an instance file. */
+std::optional<std::pair<size_t, size_t>> grid_size(std::string_view instance)
+{
+    if (!instance.starts_with("grid:")) return std::nullopt;
+    size_t width = 0, height = 0;
+    if (std::sscanf(instance.data(), "grid:%zux%zu", &width, &height) != 2 or width == 0 or height == 0)
+        throw std::runtime_error("Invalid grid size.");
+    return std::pair(width, height);
+}
+
+
+/* Reads the instance file, or generates a shuffled synthetic grid for "grid:<width>x<height>", or a
+random network with capacities up to 2^30 for "random:<nodes>x<arcs>". */
+FlowNetwork load_instance(std::string_view instance)
+{
+    if (instance.starts_with("random:")) {
+        size_t n = 0, m = 0;
+        if (std::sscanf(instance.data(), "random:%zux%zu", &n, &m) != 2 or n < 2)
+            throw std::runtime_error("Invalid random network size.");
+        return generate_random_network(n, m, flow_t{1} << 30);
+    }
+    auto const grid = grid_size(instance);
+    if (!grid) return read_maxflow_instance(instance);
+    return generate_grid_network(grid->first, grid->second, 1, true);
+}
+
+
+/* Runs solve and returns the peak memory it added to the resident memory before it, with its result. */
+template <typename Solve>
+auto peak_memory_of(Solve&& solve)
+{
+#ifdef __GLIBC__
+    malloc_trim(0); // or the freed memory reused by the solve would hide part of its peak
+#endif
+    reset_peak_rss();
+    auto const baseline = peak_rss();
+    auto result = solve();
+    return std::pair(peak_rss() - baseline, std::move(result));
+}
+
+
+/* Solves the instance with Dinitz-Cherkassky, loading it again: keeping the network to get the flow,
+then handing it over to the solver, which releases its arcs while building the residual network.
+Reports the peak memory of both above the resident memory before the load. */
+void benchmark_handover(FlowNetwork const& network, std::string_view instance)
+{
+    std::cout << "\nHanding the network over (peak memory above the baseline)\n";
+    auto const [kept, kept_flow] = peak_memory_of([&] {
+        auto const copy = load_instance(instance);
+        return DinitzCherkassky{copy}();
+    });
+    auto const [handed, handed_flow] = peak_memory_of([&] { return DinitzCherkassky{load_instance(instance)}(); });
+    std::cout << "Kept: " << (kept >> 20) << "MB, handed over: " << (handed >> 20) << "MB\n";
+    std::cout << "Certificate: " << (verify_flow(network, kept_flow) and verify_flow(network, handed_flow) ? "valid" : "INVALID") << '\n';
+}
+
+
+/* Generates the synthetic grid again and solves it with Dinitz-Cherkassky: given to a GraphBuilder,
+which fills the residual network directly, then as a FlowNetwork handed over to the solver. Reports
+the peak memory of both above the resident memory before the generation. */
+void benchmark_builder(FlowNetwork const& network, std::string_view instance)
+{
+    auto const grid = grid_size(instance);
+    if (!grid) throw std::runtime_error("The graph builder needs a synthetic grid instance.");
+    auto const [width, height] = *grid;
+    std::cout << "\nGraph builder (peak memory above the baseline)\n";
+    auto const [built, built_flow] = peak_memory_of([&] {
+        auto builder = generate_grid_builder(width, height, 1, true);
+        auto const capacities = builder.capacities();
+        DinitzCherkassky solver(std::move(builder).build());
+        auto const maxflow = solver.solve();
+        return Flow{maxflow, get_flow_arcs(capacities, solver.rnetwork)};
+    });
+    auto const [handed, handed_flow] = peak_memory_of([&] {
+        return DinitzCherkassky{generate_grid_network(width, height, 1, true)}();
+    });
+    std::cout << "Maximum flow value: " << built_flow.value << (built_flow.value == handed_flow.value ? "\n" : " - MISMATCH\n");
+    std::cout << "Through a GraphBuilder: " << (built >> 20) << "MB, through a FlowNetwork: " << (handed >> 20) << "MB\n";
+    auto const built_network = generate_grid_builder(width, height, 1, true).flow_network();
+    std::cout << "Certificate: " << (verify_flow(built_network, built_flow) and verify_flow(network, handed_flow) ? "valid" : "INVALID") << '\n';
+}
+
+
+/* Solves capacity scenarios of the network (its capacities plus a small perturbation) concurrently,
+one thread each, for 1, 2, 4... threads: with a residual network per thread, then with one shared
+topology and a residual capacities array per thread. Reports the peak memory of both (which includes
+the input network), the latter should stay flat as the number of threads grows. */
+void benchmark_scenarios(FlowNetwork const& network, size_t max_thread_count)
+{
+    auto const scenario_capacity = [&](size_t scenario, size_t a) {
+        return network.arcs[a].capacity + static_cast<flow_t>((a + scenario) % 4);
+    };
+    std::cout << "\nCapacity scenarios (peak memory)\n";
+    for (size_t threads = 1; threads <= max_thread_count; threads *= 2) {
+        std::vector<flow_t> values[2] = {std::vector<flow_t>(threads), std::vector<flow_t>(threads)};
+        size_t peak[2];
+        for (int shared = 0; shared < 2; ++shared) {
+            reset_peak_rss();
+            {
+                std::optional<ResidualTopology> topology;
+                if (shared) topology.emplace(network);
+                std::vector<std::jthread> workers;
+                for (size_t scenario = 0; scenario < threads; ++scenario)
+                    workers.emplace_back([&, scenario] {
+                        std::vector<flow_t> capacities(network.m);
+                        for (size_t a = 0; a < network.m; ++a) capacities[a] = scenario_capacity(scenario, a);
+                        if (shared) {
+                            auto residual_capacities = topology->residual_capacities(capacities);
+                            values[shared][scenario] = DinitzCherkassky(topology->view(residual_capacities)).solve();
+                        } else {
+                            auto arcs = std::views::iota(size_t{0}, network.m) | std::views::transform([&](size_t a) {
+                                return CapacityArc{network.arcs[a].tail, network.arcs[a].head, capacities[a]};
+                            });
+                            values[shared][scenario] = DinitzCherkassky(ResidualNetwork(network.n, network.source, network.sink, arcs)).solve();
+                        }
+                    });
+            }
+            peak[shared] = peak_rss();
+        }
+        std::cout << "Threads: " << threads << ", " << (peak[0] >> 20) << "MB with a residual network each, "
+                  << (peak[1] >> 20) << "MB sharing the topology" << (values[0] == values[1] ? "\n" : " - MISMATCH\n");
+    }
 
-    std::cout << "\nAlgorithm: \"Dinitz-Cherkassky\"\n";
+    // checks the flow of a scenario solved over the shared topology
+    auto scenario = network;
+    for (size_t a = 0; a < network.m; ++a) scenario.arcs[a].capacity = scenario_capacity(1, a);
+    ResidualTopology topology(scenario);
+    auto const capacities = arc_capacities(scenario);
+    auto residual_capacities = topology.residual_capacities(capacities);
+    Flow flow{DinitzCherkassky(topology.view(residual_capacities)).solve(), {}};
+    flow.flow_arcs = topology.flow_arcs(capacities, residual_capacities);
+    std::cout << "Certificate: " << (verify_flow(scenario, flow) ? "valid" : "INVALID") << '\n';
+}
+
+
+/* Answers maximum flow queries between random pairs of nodes: by building a residual network per
+query, then with MaxflowQueries, one query at a time and concurrently. */
+void benchmark_queries(FlowNetwork const& network, size_t query_count)
+{
+    std::mt19937_64 random(1);
+    std::uniform_int_distribution<node_t> node(0, static_cast<node_t>(network.n - 1));
+    std::vector<MaxflowQueries::Query> queries;
+    while (std::size(queries) < query_count)
+        if (auto const query = std::pair(node(random), node(random)); query.first != query.second) queries.push_back(query);
+
+    std::cout << "\nMaximum flow queries: " << query_count << '\n';
+    std::vector<flow_t> maxflows[3];
     {
+        std::cout << "Rebuilding per query: ";
         Timer t;
-        std::cout << "Maximum flow value: " << DinitzCherkassky{network}().value << '\n';
+        for (auto [source, sink] : queries) {
+            auto query = network;
+            query.source = source;
+            query.sink = sink;
+            maxflows[0].push_back(DinitzCherkassky{std::move(query)}.solve());
+        }
     }
+    MaxflowQueries answer(network);
+    {
+        std::cout << "Resetting the residual capacities: ";
+        Timer t;
+        MaxflowQueries::Worker worker(answer);
+        for (auto [source, sink] : queries) maxflows[1].push_back(worker(source, sink));
+    }
+    {
+        std::cout << "Concurrently (" << thread_count() << " threads): ";
+        Timer t;
+        maxflows[2] = answer(queries);
+    }
+    std::cout << "Values: " << (maxflows[1] == maxflows[0] and maxflows[2] == maxflows[0] ? "agree" : "MISMATCH") << '\n';
+}
+
+
+/* Solves the network through the C interface of libmaxflow (see maxflow_c.h): from its arcs arrays
+with maxflow_graph_create and maxflow_solve, then from the compressed sparse row arrays of its
+residual network with maxflow_solve_csr. */
+void benchmark_c_interface(FlowNetwork const& network)
+{
+    auto const check = [](maxflow_status status) {
+        if (status != MAXFLOW_OK) throw std::runtime_error(std::string("C interface: ") + maxflow_status_string(status));
+    };
+    benchmark("Dinitz-Cherkassky (C interface)", Solver::DinitzCherkassky, network, [&](FlowNetwork const& network) {
+        std::vector<std::uint32_t> tails(network.m), heads(network.m), capacities(network.m);
+        for (size_t a = 0; a < network.m; ++a)
+            std::tie(tails[a], heads[a], capacities[a]) = std::tuple(network.arcs[a].tail, network.arcs[a].head, network.arcs[a].capacity);
+        std::unique_ptr<maxflow_graph, void (*)(maxflow_graph*)> graph(maxflow_graph_create(network.n, network.m,
+            network.source, network.sink, tails.data(), heads.data(), capacities.data()), maxflow_graph_destroy);
+        if (!graph) throw std::runtime_error("C interface: the graph wasn't created.");
+        check(maxflow_solve(graph.get(), MAXFLOW_DINITZ_CHERKASSKY));
+        Flow flow{maxflow_value(graph.get()), std::vector<flow_t>(network.m)};
+        check(maxflow_flow_arcs(graph.get(), flow.flow_arcs.data()));
+        return flow;
+    });
+    benchmark("Dinitz-Cherkassky (C interface, CSR arrays)", Solver::DinitzCherkassky, network, [&](FlowNetwork const& network) {
+        ResidualTopology topology(network);
+        auto const capacities = arc_capacities(network);
+        auto residual_capacities = topology.residual_capacities(capacities);
+        Flow flow;
+        check(maxflow_solve_csr(topology.n, topology.source, topology.sink, topology.first_out.data(), topology.heads.data(),
+            topology.twins.data(), residual_capacities.data(), MAXFLOW_DINITZ_CHERKASSKY, &flow.value));
+        flow.flow_arcs = topology.flow_arcs(capacities, residual_capacities);
+        return flow;
+    });
 
-    std::cout << "\nAlgorithm: \"Edmonds-Karp\"\n";
+    // malformed arrays are rejected instead of being read out of bounds
+    ResidualTopology topology(network);
+    if (topology.m == 0) return;
+    auto twins = topology.twins;
+    twins[0] = static_cast<arc_t>(topology.m);
+    std::vector<flow_t> residual_capacities(topology.m, 0);
+    flow_t value = 0;
+    auto const status = maxflow_solve_csr(topology.n, topology.source, topology.sink, topology.first_out.data(),
+        topology.heads.data(), twins.data(), residual_capacities.data(), MAXFLOW_DINITZ_CHERKASSKY, &value);
+    std::cout << "\nMalformed CSR arrays: " << maxflow_status_string(status)
+              << (status == MAXFLOW_INVALID_ARGUMENT ? "\n" : " - UNEXPECTED\n");
+}
+
+
+/* Computes a minimum cut of a pixel grid instance by dual decomposition into the given number of
+strips, solved concurrently, and checks it against the lower bound of the decomposition. */
+void benchmark_decomposition(FlowNetwork const& network, std::string_view filepath, size_t piece_count)
+{
+    auto const grid = read_regular_grid(filepath);
+    if (!grid) throw std::runtime_error("The decomposition needs a \"c regulargrid <width> <height>\" line.");
+    std::cout << "\nDual decomposition: " << piece_count << " strips of a " << grid->first << 'x' << grid->second << " grid\n";
+    GridCut cut;
     {
         Timer t;
-        std::cout << "Maximum flow value: " << edmonds_karp(network).value << '\n';
+        cut = DualDecomposition(network, grid->first, grid->second, piece_count).solve();
+        std::cout << "Minimum cut capacity: " << cut.value << " (" << cut.iterations << " iterations, "
+                  << cut.pieces << " strips in the end)\n";
+    }
+    std::cout << "Certificate: " << (cut.optimal() ? "valid" : "INVALID") << " (lower bound " << cut.lower_bound << ")\n";
+}
+
+
+/* Solves the successive alpha-expansion moves given as instance files on the same grid: from
+scratch, then with the grid's storage reused, then with the previous move's flow reused as well. */
+void benchmark_expansion(std::span<char*> moves)
+{
+    auto const grid = read_regular_grid(moves[0]);
+    if (!grid) throw std::runtime_error("The moves need a \"c regulargrid <width> <height>\" line.");
+    std::cout << "\nAlpha-expansion: " << std::size(moves) << " moves on a " << grid->first << 'x' << grid->second << " grid\n";
+    AlphaExpansion reused(grid->first, grid->second, false), reused_flow(grid->first, grid->second, true);
+    std::chrono::milliseconds total[3] = {};
+    for (auto move : moves) {
+        flow_t value[3];
+        auto const time = [&](int i, auto&& solve) {
+            auto const start = std::chrono::steady_clock::now();
+            value[i] = solve();
+            auto const duration = duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            total[i] += duration;
+            return duration.count();
+        };
+        auto const scratch = time(0, [&] { return DinitzCherkassky{read_maxflow_instance(move)}.solve(); });
+        auto const storage = time(1, [&] { return reused.solve_move(move); });
+        auto const flow = time(2, [&] { return reused_flow.solve_move(move); });
+        std::cout << "Move \"" << move << "\": maximum flow value " << value[0] << ", " << scratch << "ms from scratch, "
+                  << storage << "ms reusing the grid, " << flow << "ms reusing the flow"
+                  << (value[1] == value[0] and value[2] == value[0] ? "\n" : " - MISMATCH\n");
     }
-}
\ No newline at end of file
+    std::cout << "Total: " << total[0].count() << "ms from scratch, " << total[1].count() << "ms reusing the grid, "
+              << total[2].count() << "ms reusing the flow\n";
+}
+
+
+int main(int argc, char* argv[])
+{
+    // minimal_example();
+
+    if (argc > 2 and std::string_view(argv[1]) == "--expansion") {
+        benchmark_expansion(std::span(argv + 2, argv + argc));
+        return 0;
+    }
+
+    if (argc < 2) throw std::runtime_error("Usage: maxflow <instance.max | grid:<width>x<height> | random:<nodes>x<arcs>> [--cache <directory>] "
+        "[--solution <file.sol>] [--out-of-core <directory>] [--processes <count>] [--async <threads>] [--decomposition <strips>] [--locality] [--goldberg-rao] [--handover] [--builder] [--scenarios <threads>] [--queries <count>], "
+        "or maxflow --expansion <move.max>...");
+    char const* cache_directory = nullptr;
+    char const* solution_filepath = nullptr;
+    char const* out_of_core_directory = nullptr;
+    size_t process_count = 0;
+    size_t async_thread_count = 0;
+    size_t piece_count = 0;
+    size_t scenario_thread_count = 0;
+    size_t query_count = 0;
+    bool locality = false, goldberg_rao = false, handover = false, builder = false;
+    for (int i = 2; i < argc; i += 2) {
+        if (std::string_view(argv[i]) == "--handover" or std::string_view(argv[i]) == "--builder") {
+            (std::string_view(argv[i]) == "--handover" ? handover : builder) = true;
+            --i;
+            continue;
+        }
+        if (std::string_view(argv[i]) == "--locality" or std::string_view(argv[i]) == "--goldberg-rao") {
+            (std::string_view(argv[i]) == "--locality" ? locality : goldberg_rao) = true;
+            --i;
+            continue;
+        }
+        if (i + 1 == argc) throw std::runtime_error("Missing option value.");
+        if (std::string_view(argv[i]) == "--cache") cache_directory = argv[i + 1];
+        else if (std::string_view(argv[i]) == "--solution") solution_filepath = argv[i + 1];
+        else if (std::string_view(argv[i]) == "--out-of-core") out_of_core_directory = argv[i + 1];
+        else if (std::string_view(argv[i]) == "--processes") process_count = std::stoul(argv[i + 1]);
+        else if (std::string_view(argv[i]) == "--async") async_thread_count = std::stoul(argv[i + 1]);
+        else if (std::string_view(argv[i]) == "--decomposition") piece_count = std::stoul(argv[i + 1]);
+        else if (std::string_view(argv[i]) == "--scenarios") scenario_thread_count = std::stoul(argv[i + 1]);
+        else if (std::string_view(argv[i]) == "--queries") query_count = std::stoul(argv[i + 1]);
+        else throw std::runtime_error("Unknown option.");
+    }
+
+    auto network = load_instance(argv[1]);
+    if (out_of_core_directory and (std::string_view(argv[1]).starts_with("grid:") or std::string_view(argv[1]).starts_with("random:")))
+        throw std::runtime_error("The out-of-core solver needs an instance file.");
+    std::cout << "\nNetwork instance: \"" << argv[1] << " - |V| = " << network.n << ", |E| = " << network.m << '\n';
+    std::cout << "Instance hash: " << std::hex << hash_flow_network(network) << std::dec << '\n';
+    if (handover or builder) {
+        if (handover) benchmark_handover(network, argv[1]);
+        if (builder) benchmark_builder(network, argv[1]);
+        return 0;
+    }
+
+    if (cache_directory or solution_filepath) {
+        std::cout << "\nSolution (cache: \"" << (cache_directory ? cache_directory : "none") << "\")\n";
+        Timer t;
+        FlowCache cache(1, cache_directory ? cache_directory : "");
+        auto const& solution = cache.find_or_solve(network, [](FlowNetwork const& network) {
+            DinitzCherkassky solver{network};
+            auto flow = solver();
+            return MaxflowSolution{std::move(flow), minimum_cut(solver.rnetwork)};
+        });
+        std::cout << "Maximum flow value: " << solution.flow.value << '\n';
+        std::cout << "Minimum cut source side: " << std::size(solution.source_side) << " nodes\n";
+        if (solution_filepath) write_maxflow_instance_solution(solution_filepath, network, solution.flow);
+    }
+
+    benchmark("Dinitz-Cherkassky", Solver::DinitzCherkassky, network,
+        [](FlowNetwork const& network) { return DinitzCherkassky{network}(); });
+    benchmark("Dinitz-Cherkassky (paired arcs)", Solver::PairedDinitzCherkassky, network, [](FlowNetwork const& network) {
+        DinitzCherkassky<PairedResidualNetwork> solver(PairedResidualNetwork{network});
+        auto const maxflow = solver.solve();
+        return Flow{maxflow, solver.rnetwork.flow_arcs(network)};
+    });
+    benchmark("Dinitz-Cherkassky (compressed arcs)", Solver::CompressedDinitzCherkassky, network,
+        [](FlowNetwork const& network) {
+            DinitzCherkassky<CompressedResidualNetwork> solver(CompressedResidualNetwork{network});
+            auto const maxflow = solver.solve();
+            return Flow{maxflow, solver.rnetwork.flow_arcs(network)};
+        });
+    benchmark("Excesses incremental BFS", Solver::IncrementalBFS, network,
+        [](FlowNetwork const& network) { return IncrementalBFS{network}(); });
+    if (locality) {
+        for (auto [name, order] : {std::pair{"Dinitz-Cherkassky (arcs sorted by head)", ArcOrder::Head},
+                                   std::pair{"Dinitz-Cherkassky (arcs to the sink first)", ArcOrder::SinkFirst}}) {
+            benchmark(name, Solver::DinitzCherkassky, network, [order](FlowNetwork const& network) {
+                ResidualNetwork rnetwork(network);
+                sort_adjacency_lists(rnetwork, order);
+                DinitzCherkassky solver(std::move(rnetwork));
+                auto const maxflow = solver.solve();
+                return Flow{maxflow, get_flow_arcs(network, solver.rnetwork)};
+            });
+        }
+        benchmark("Dinitz-Cherkassky (renumbered nodes, arcs sorted by head)", Solver::DinitzCherkassky, network,
+            [](FlowNetwork const& network) {
+                auto renumbered = network;
+                renumber_nodes(renumbered, bfs_node_order(renumbered));
+                ResidualNetwork rnetwork(renumbered);
+                sort_adjacency_lists(rnetwork, ArcOrder::Head);
+                DinitzCherkassky solver(std::move(rnetwork));
+                auto const maxflow = solver.solve();
+                return Flow{maxflow, get_flow_arcs(renumbered, solver.rnetwork)}; // the arcs kept their indices
+            });
+    }
+    benchmark_c_interface(network);
+    benchmark("Region push-relabel", Solver::RegionPushRelabel, network, [](FlowNetwork const& network) {
+        RegionPushRelabel solver(ResidualNetwork(network), thread_count());
+        auto const maxflow = solver.solve();
+        return Flow{maxflow, get_flow_arcs(network, solver.rnetwork)};
+    });
+    if (has_unit_capacities(network)) {
+        benchmark("Dinitz (unit capacities)", Solver::UnitDinitz, network,
+            [](FlowNetwork const& network) { return dinitz(network); });
+    }
+    if (detect_bipartite_matching(network)) {
+        benchmark("Hopcroft-Karp (bipartite matching)", Solver::HopcroftKarp, network,
+            [](FlowNetwork const& network) { return HopcroftKarp(*detect_bipartite_matching(network))(network); });
+    }
+    if (out_of_core_directory) {
+        benchmark("Region push-relabel (out-of-core)", Solver::RegionPushRelabel, network, [&](FlowNetwork const&) {
+            MappedResidualNetwork mnetwork(argv[1], out_of_core_directory);
+            auto const maxflow = solve_out_of_core(mnetwork);
+            return Flow{maxflow, mnetwork.flow_arcs()};
+        });
+    }
+    if (process_count > 0) {
+        benchmark("Multi-process push-relabel", Solver::RegionPushRelabel, network,
+            [=](FlowNetwork const& network) { return multiprocess_push_relabel(network, process_count); });
+    }
+    for (size_t threads = 1; threads <= async_thread_count; threads *= 2) {
+        auto const name = "Asynchronous push-relabel (" + std::to_string(threads) + " threads)";
+        benchmark(name.c_str(), Solver::AsyncPushRelabel, network, [=](FlowNetwork const& network) {
+            return AsyncPushRelabel(ResidualNetwork(network), threads)(network);
+        });
+    }
+    if (goldberg_rao) {
+        benchmark("Goldberg-Rao", Solver::GoldbergRao, network,
+            [](FlowNetwork const& network) { return GoldbergRao{network}(); });
+    }
+    if (piece_count > 0) benchmark_decomposition(network, argv[1], piece_count);
+    if (scenario_thread_count > 0) benchmark_scenarios(network, scenario_thread_count);
+    if (query_count > 0) benchmark_queries(network, query_count);
+    benchmark("Edmonds-Karp", Solver::EdmondsKarp, network,
+        [](FlowNetwork const& network) { return edmonds_karp(network); });
+}
@@ -1,18 +1,49 @@
 #pragma once
 
 #include <algorithm>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <limits>
+#include <memory>
 #include <ranges>
 #include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "parallel.hpp"
+#if __has_include(<sys/mman.h>) and __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MAXFLOW_HAS_MADVISE 1
+#endif
 
 
-/* For educational purposes, there is no need to use templates here. Let's keep the code simple. */
+/* For educational purposes, the value types are fixed, templates are only used to let the solvers
+run on the different residual network representations. Let's keep the code simple. */
 using size_t = std::size_t;
 using node_t = std::uint32_t; // nodes are represented with an unique unsigned integer between 0 and n = |V| (excluded).
 using flow_t = std::uint32_t;
+using arc_t = std::uint32_t; // index of an arc in the arrays based residual networks
+
+
+/* Software prefetching distance, in arcs, of the DFS and BFS scans of DinitzCherkassky: the data
+behind the arc that many positions ahead (the rank of its head, its reverse arc) is requested before
+it is needed, which hides the latency of these random accesses on graphs exceeding the last level
+cache. 0 disables it (the default), set it at compile time, e.g. -DMAXFLOW_PREFETCH_DISTANCE=8 (the
+CMake option of the same name). */
+#ifndef MAXFLOW_PREFETCH_DISTANCE
+#define MAXFLOW_PREFETCH_DISTANCE 0
+#endif
+inline constexpr std::ptrdiff_t PrefetchDistance = MAXFLOW_PREFETCH_DISTANCE;
+
+inline void prefetch([[maybe_unused]] void const* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#endif
+}
 
 
 struct CapacityArc
@@ -60,26 +91,133 @@ struct ResidualArc
 };
 
 
+/* Pairs up the antiparallel arcs of a flow network: partner[a] is the index of an arc going the other
+way between the same nodes, or NoPartner. An arc gets at most one partner (parallel arcs aren't mer-
+ged, neither are loops), they are found in O(n + m) by bucketing the arcs on their smaller endpoint,
+a stamp array telling which other endpoints were already seen in the bucket. Two arcs whose capaci-
+ties sum beyond flow_t aren't paired: the residual capacities of a pair always sum to it. */
+constexpr auto NoPartner = std::numeric_limits<arc_t>::max();
+
+template <std::ranges::random_access_range Arcs>
+std::vector<arc_t> antiparallel_partners(size_t n, Arcs&& arcs)
+{
+    auto const arc_at = std::ranges::begin(arcs);
+    auto const m = static_cast<size_t>(std::ranges::size(arcs));
+    std::vector<arc_t> first(n + 1, 0), bucket(m), partner(m, NoPartner);
+    for (auto const& [u, v, capacity] : arcs) ++first[std::min(u, v) + 1];
+    for (size_t u = 0; u < n; ++u) first[u + 1] += first[u];
+    std::vector<arc_t> cursor(begin(first), end(first) - 1);
+    for (size_t a = 0; a < m; ++a) bucket[cursor[std::min(arc_at[a].tail, arc_at[a].head)]++] = static_cast<arc_t>(a);
+
+    auto& stamp = cursor; // stamp[y] == x iff an arc between x and y was seen while scanning bucket x
+    std::ranges::fill(stamp, std::numeric_limits<arc_t>::max());
+    std::vector<arc_t> pending(n); // an unpaired arc between x and y, if any
+    for (size_t x = 0; x < n; ++x)
+        for (auto i = first[x]; i < first[x + 1]; ++i) {
+            auto const a = bucket[i];
+            auto const [u, v, capacity] = arc_at[a];
+            if (u == v) continue;
+            auto const y = u == x ? v : u;
+            if (stamp[y] != x) {
+                stamp[y] = static_cast<arc_t>(x);
+                pending[y] = a;
+            } else if (pending[y] == NoPartner) {
+                pending[y] = a;
+            } else if (arc_at[pending[y]].tail != u
+                and capacity <= std::numeric_limits<flow_t>::max() - arc_at[pending[y]].capacity) {
+                partner[a] = pending[y];
+                partner[pending[y]] = a;
+                pending[y] = NoPartner;
+            }
+        }
+    return partner;
+}
+
+
+/* An allocator whose containers default-initialize their elements instead of value-initializing
+them, i.e. a resized vector of trivial elements isn't zeroed: the pages of a large array are then
+only touched (made resident) when they are written. */
+template <typename T>
+struct DefaultInitAllocator : std::allocator<T>
+{
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) ::new (static_cast<void*>(p)) U;
+        else ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+
+/* Shrinks the arcs list to its first size arcs, returning the whole pages past them (up to the
+previous size) to the operating system where madvise is available, instead of reallocating the list
+(which would copy the arcs left, momentarily doubling them). */
+inline void release_arcs_tail(std::vector<CapacityArc>& arcs, size_t size)
+{
+#ifdef MAXFLOW_HAS_MADVISE
+    static auto const page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto const address = [&](size_t a) { return reinterpret_cast<std::uintptr_t>(arcs.data() + a); };
+    auto const first = (address(size) + page_size - 1) & ~(page_size - 1);
+    auto const last = std::min((address(std::size(arcs)) + page_size - 1) & ~(page_size - 1),
+        address(arcs.capacity()) & ~(page_size - 1)); // a partial last page may hold another allocation
+    if (first < last) madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+#endif
+    arcs.resize(size);
+}
+
+
 /* Represents a residual network with contiguous memory adjacency lists (glued together in a vector,
-and accessed individually with a std::span). Neighbors queries should be fast. */
+and accessed individually with a std::span). Neighbors queries should be fast. Two antiparallel arcs
+(u, v) and (v, u) of the flow network are merged into a single pair of residual arcs, each one with
+its own capacity as residual capacity, instead of two pairs with a zero-capacity reverse arc each
+(the grid instances have all their arcs in both directions, so this halves the adjacency lists). The
+position of the residual arc of each input arc is recorded, so the flow can be gathered directly and
+the adjacency lists can be reordered, as long as these positions follow. */
 struct ResidualNetwork
 {
-    size_t n, m; // number of vertices (resp. arcs)
+    size_t n, m; // number of vertices (resp. residual arcs)
     node_t source, sink;
-    std::vector<ResidualArc> adjlist; // "glued" adjacency lists
+    std::vector<ResidualArc, DefaultInitAllocator<ResidualArc>> adjlist; // "glued" adjacency lists
     std::vector<std::span<ResidualArc>> arcs_out_span;
+    std::vector<arc_t> original_arc; // position in adjlist of the residual arc of each input arc
+
+    static constexpr auto NoArc = std::numeric_limits<arc_t>::max(); // an input arc left out, without flow
 
     auto nodes() const { return std::ranges::iota_view{node_t{0}, n}; }
     auto arcs_out(node_t node) const { return arcs_out_span[node]; }
     auto degree_out(node_t node) const { return std::size(arcs_out_span[node]); }
 
-    ResidualNetwork(FlowNetwork const& network) : n(network.n), m(2 * network.m),
-        source(network.source), sink(network.sink), adjlist(m), arcs_out_span(n)
+    // the common adjacency interface (see ResidualGraph), arcs are handled by reference here
+    static node_t head(ResidualArc const& arc) { return arc.head; }
+    static ResidualArc& twin(ResidualArc const& arc) { return *arc.twin; }
+    static flow_t residual_capacity(ResidualArc const& arc) { return arc.residual_capacity; }
+    static void push_flow(ResidualArc& arc, flow_t flow) { arc.push_flow(flow); }
+
+    ResidualNetwork(FlowNetwork const& network) :
+        ResidualNetwork(network.n, network.source, network.sink, network.arcs) {}
+
+    /* An empty network of n nodes, whose arcs are then filled in by a builder (see GraphBuilder). */
+    ResidualNetwork(size_t n, node_t source, node_t sink) : n(n), m(0), source(source), sink(sink),
+        arcs_out_span(n) {}
+
+    /* Builds the residual network from any random access range of CapacityArc (e.g. a view over
+    arrays owned by the caller), so the arcs don't need to be copied into a FlowNetwork first. */
+    template <std::ranges::random_access_range Arcs>
+    ResidualNetwork(size_t n, node_t source, node_t sink, Arcs&& arcs) : n(n), m(0), source(source),
+        sink(sink), arcs_out_span(n), original_arc(std::ranges::size(arcs))
     {
-        // compute the out degree for all nodes
+        auto const arc_at = std::ranges::begin(arcs);
+        auto const arc_count = static_cast<size_t>(std::ranges::size(arcs));
+        auto const partner = antiparallel_partners(n, arcs);
+
+        // compute the out degree for all nodes, a merged pair being counted with its first arc
         std::vector<node_t> degree_out(n, 0);
-        for (auto const& [u, v, capacity] : network.arcs) { ++degree_out[u]; ++degree_out[v]; }
-        
+        for (size_t a = 0; a < arc_count; ++a)
+            if (partner[a] == NoPartner or partner[a] > a) {
+                ++degree_out[arc_at[a].tail]; ++degree_out[arc_at[a].head];
+                m += 2;
+            }
+        adjlist.resize(m);
+
         // set up first iterator in the glued adjacency lists for all nodes
         std::vector<decltype(adjlist)::iterator> adjlist_iter(n + 1);
         adjlist_iter[0] = begin(adjlist);
@@ -89,13 +227,67 @@ struct ResidualNetwork
         }
 
         // finally fill the adjacency lists
-        for (auto const& [u, v, capacity] : network.arcs) {
+        for (size_t a = 0; a < arc_count; ++a) {
+            if (partner[a] != NoPartner and partner[a] < a) continue;
+            auto const [u, v, capacity] = arc_at[a];
+            original_arc[a] = static_cast<arc_t>(adjlist_iter[u] - begin(adjlist));
+            if (partner[a] != NoPartner) original_arc[partner[a]] = static_cast<arc_t>(adjlist_iter[v] - begin(adjlist));
             *adjlist_iter[u] = {v, capacity, &*adjlist_iter[v]};
-            *adjlist_iter[v] = {u, 0, &*adjlist_iter[u]};
+            *adjlist_iter[v] = {u, partner[a] == NoPartner ? 0 : arc_at[partner[a]].capacity, &*adjlist_iter[u]};
             ++adjlist_iter[u]; ++adjlist_iter[v];
         }
     }
 
+    /* Builds the residual network while consuming the arcs of the network, which is left without any:
+    they are placed last arc first, each list being filled from its end, and the arcs list is shrunk
+    as it goes (see release_arcs_tail), so the adjacency lists and the arcs list are never both whole
+    in memory. The capacity of each arc, all that the flow retrieval needs from the input arcs, is
+    written into capacities. The partners of the merged pairs are kept in original_arc until the
+    positions replace them, and the adjacency lists are the same as from the arcs list. */
+    ResidualNetwork(FlowNetwork&& network, std::vector<flow_t>& capacities) : n(network.n), m(0),
+        source(network.source), sink(network.sink), arcs_out_span(n),
+        original_arc(antiparallel_partners(n, network.arcs))
+    {
+        auto& arcs = network.arcs;
+        auto const arc_count = std::size(arcs);
+        auto const& partner = original_arc;
+
+        // compute the out degree for all nodes, a merged pair being counted with its first arc
+        std::vector<node_t> degree_out(n, 0);
+        for (size_t a = 0; a < arc_count; ++a)
+            if (partner[a] == NoPartner or partner[a] > a) {
+                ++degree_out[arcs[a].tail]; ++degree_out[arcs[a].head];
+                m += 2;
+            }
+        adjlist.resize(m); // not zeroed: its pages become resident as they are written
+
+        // set up the end of each list in the glued adjacency lists, the lists are filled backwards
+        std::vector<decltype(adjlist)::iterator> adjlist_iter(n);
+        auto list_end = begin(adjlist);
+        for (auto u : nodes()) {
+            arcs_out_span[u] = std::span(list_end, list_end + degree_out[u]);
+            adjlist_iter[u] = list_end += degree_out[u];
+        }
+
+        constexpr size_t ReleaseStep = 1 << 16; // arcs
+        capacities.resize(arc_count);
+        for (auto a = arc_count; a-- > 0;) {
+            auto const [u, v, capacity] = arcs[a];
+            capacities[a] = capacity;
+            if (auto const p = partner[a]; p == NoPartner or p > a) { // the second arc of a pair comes first
+                auto& uv = *--adjlist_iter[u];
+                auto& vu = *--adjlist_iter[v];
+                uv = {v, capacity, &vu};
+                vu = {u, p == NoPartner ? 0 : capacities[p], &uv};
+                original_arc[a] = static_cast<arc_t>(&uv - adjlist.data());
+                if (p != NoPartner) original_arc[p] = static_cast<arc_t>(&vu - adjlist.data());
+            }
+            if (a % ReleaseStep == 0) release_arcs_tail(arcs, a);
+        }
+        arcs = std::vector<CapacityArc>(); // frees the memory, unlike clear()
+        network.m = 0;
+    }
+
     auto print() const {
         std::printf("Residual Network G = (V, A) - |V| = %zu, |A| = %zu\n", n, m);
         for (auto u : nodes()) {
@@ -108,26 +300,140 @@ struct ResidualNetwork
 };
 
 
-/* Retrieves the flow value of each arc in the network given an associated residual network in O(m),
-since the original arc can't be differentiated from its reverse arc in the residual network. */
-auto get_flow_arcs(FlowNetwork const& network, ResidualNetwork const& rnetwork) {
-    std::vector<flow_t> flow_arcs;
-    flow_arcs.reserve(network.m);
-    std::vector<std::span<ResidualArc>::iterator> current_arc(network.n);
-    for (auto u : rnetwork.nodes()) current_arc[u] = begin(rnetwork.arcs_out(u));
-    for (auto const& [u, v, capacity] : network.arcs) {
-        flow_arcs.push_back(current_arc[u]->twin->residual_capacity);
-        ++current_arc[u]; ++current_arc[v];
+/* Represents a residual network in the compressed sparse row format, as a view over arrays owned by
+someone else (e.g. an upstream stage which already holds its graph this way), without any copy. The
+arcs out of node u are [first_out[u], first_out[u + 1]), arc a goes to heads[a] and its reverse arc
+is twins[a]. The residual capacities are initialized by the owner with the arc capacities (0 for a
+pure reverse arc) and are updated in place by the solvers, the flow on an arc being the difference
+between its initial and final residual capacities. The arrays are checked in O(n + m) on construction
+(offsets, heads and reverse arcs in range and consistent, distinct terminals), since the solvers index
+them blindly. */
+struct ResidualNetworkView
+{
+    size_t n, m; // number of vertices (resp. arcs)
+    node_t source, sink;
+    std::span<arc_t const> first_out; // n + 1 offsets in the arcs arrays
+    std::span<node_t const> heads;
+    std::span<arc_t const> twins;
+    std::span<flow_t> residual_capacities;
+
+    auto nodes() const { return std::ranges::iota_view{node_t{0}, n}; }
+    auto arcs_out(node_t node) const { return std::ranges::iota_view{first_out[node], first_out[node + 1]}; }
+    auto degree_out(node_t node) const { return size_t{first_out[node + 1] - first_out[node]}; }
+
+    // the common adjacency interface (see ResidualGraph), arcs are handled by index here
+    node_t head(arc_t arc) const { return heads[arc]; }
+    arc_t twin(arc_t arc) const { return twins[arc]; }
+    flow_t residual_capacity(arc_t arc) const { return residual_capacities[arc]; }
+    void push_flow(arc_t arc, flow_t flow) const {
+        residual_capacities[arc] -= flow;
+        residual_capacities[twins[arc]] += flow;
+    }
+
+    ResidualNetworkView(node_t source, node_t sink, std::span<arc_t const> first_out,
+        std::span<node_t const> heads, std::span<arc_t const> twins, std::span<flow_t> residual_capacities) :
+        n(std::size(first_out) - 1), m(std::size(heads)), source(source), sink(sink), first_out(first_out),
+        heads(heads), twins(twins), residual_capacities(residual_capacities)
+    {
+        if (std::empty(first_out) or first_out.front() != 0 or first_out.back() != m or std::size(twins) != m
+            or std::size(residual_capacities) != m or source >= n or sink >= n or source == sink
+            or !std::ranges::is_sorted(first_out))
+            throw std::invalid_argument("Inconsistent residual network arrays.");
+        for (auto u : nodes())
+            for (auto a : arcs_out(u))
+                if (heads[a] >= n or twins[a] >= m or twins[a] == a or twins[twins[a]] != a or heads[twins[a]] != u)
+                    throw std::invalid_argument("Inconsistent residual network arrays.");
     }
+};
+
+
+/* The adjacency interface the solvers are written against: the nodes, the arcs out of a node, given
+as handles (references or indices, depending on the representation), and the head, reverse arc and
+residual capacity of an arc. */
+template <typename Network>
+using arc_handle_t = std::ranges::range_reference_t<decltype(std::declval<Network const&>().arcs_out(0))>;
+
+template <typename Network>
+concept ResidualGraph = requires(Network const& network, node_t u, arc_handle_t<Network> arc, flow_t flow) {
+    { network.n } -> std::convertible_to<size_t>;
+    { network.source } -> std::convertible_to<node_t>;
+    { network.sink } -> std::convertible_to<node_t>;
+    { network.arcs_out(u) } -> std::ranges::forward_range;
+    { network.head(arc) } -> std::convertible_to<node_t>;
+    { network.residual_capacity(arc) } -> std::convertible_to<flow_t>;
+    { network.residual_capacity(network.twin(arc)) } -> std::convertible_to<flow_t>;
+    network.push_flow(arc, flow);
+};
+
+
+/* Retrieves the flow value of each input arc with a parallel gather in O(m): its capacity, given by
+capacity(a), minus the residual capacity of its residual arc (see ResidualNetwork::original_arc), or
+0 when a merged pair carries its net flow the other way or when the arc has no residual arc. */
+template <typename Capacity>
+std::vector<flow_t> gather_flow_arcs(ResidualNetwork const& rnetwork, Capacity&& capacity) {
+    std::vector<flow_t> flow_arcs(std::size(rnetwork.original_arc));
+    parallel_for(std::size(flow_arcs), [&](size_t first, size_t last) {
+        for (auto a = first; a < last; ++a) {
+            if (rnetwork.original_arc[a] == ResidualNetwork::NoArc) {
+                flow_arcs[a] = 0;
+                continue;
+            }
+            flow_t const arc_capacity = capacity(a), residual = rnetwork.adjlist[rnetwork.original_arc[a]].residual_capacity;
+            flow_arcs[a] = arc_capacity > residual ? arc_capacity - residual : 0;
+        }
+    });
     return flow_arcs;
-} 
+}
 
+/* The flow of each arc of the range the residual network was built from. */
+template <std::ranges::random_access_range Arcs>
+    requires std::same_as<std::ranges::range_value_t<Arcs>, CapacityArc>
+auto get_flow_arcs(Arcs&& arcs, ResidualNetwork const& rnetwork) {
+    return gather_flow_arcs(rnetwork, [arc_at = std::ranges::begin(arcs)](size_t a) { return arc_at[a].capacity; });
+}
 
-/* Edmonds-Karp algorithm for computing the maximum flow of the given flow network in O(nm²). */
-Flow edmonds_karp(FlowNetwork const& network)
+/* Same, from the capacities alone once the input arcs are released. */
+inline auto get_flow_arcs(std::span<flow_t const> capacities, ResidualNetwork const& rnetwork) {
+    return gather_flow_arcs(rnetwork, [capacities](size_t a) { return capacities[a]; });
+}
+
+/* The capacity of each arc, all that the flow retrieval needs from the input arcs. */
+inline std::vector<flow_t> arc_capacities(FlowNetwork const& network) {
+    std::vector<flow_t> capacities(network.m);
+    std::ranges::transform(network.arcs, begin(capacities), &CapacityArc::capacity);
+    return capacities;
+}
+
+inline auto get_flow_arcs(FlowNetwork const& network, ResidualNetwork const& rnetwork) {
+    return get_flow_arcs(network.arcs, rnetwork);
+}
+
+
+/* Computes a minimum s-t cut from the residual network of a maximum flow: the source side of the
+cut is the set of nodes still reachable from the source with residual arcs. Returns these nodes in
+BFS order (the source first). */
+template <ResidualGraph Network>
+auto minimum_cut(Network const& rnetwork) {
+    std::vector<node_t> source_side(rnetwork.n);
+    std::vector<bool> reached(rnetwork.n, false);
+    source_side[0] = rnetwork.source;
+    reached[rnetwork.source] = true;
+    auto last = begin(source_side) + 1;
+    for (auto u = begin(source_side); u != last; ++u)
+        for (auto&& arc : rnetwork.arcs_out(*u))
+            if (!reached[rnetwork.head(arc)] and rnetwork.residual_capacity(arc) != 0) {
+                reached[rnetwork.head(arc)] = true;
+                *(last++) = rnetwork.head(arc);
+            }
+    source_side.erase(last, end(source_side));
+    return source_side;
+}
+
+
+/* Edmonds-Karp algorithm for computing the maximum flow of the given residual network in O(nm²).
+Returns the maximum flow value, the flow itself is left in the residual network. */
+inline flow_t edmonds_karp(ResidualNetwork& rnetwork)
 {
-    ResidualNetwork rnetwork(network);
-    
     std::vector<node_t> bfs_ordering(rnetwork.n); // a "queue-less" BFS is implemented
     bfs_ordering[0] = rnetwork.source;
     std::vector<ResidualArc*> pred(rnetwork.n); // stores an s-t augmenting path
@@ -166,43 +472,91 @@ Flow edmonds_karp(FlowNetwork const& network)
         maxflow += min_residual_capacity;
     }
 
+    return maxflow;
+}
+
+
+inline Flow edmonds_karp(FlowNetwork const& network)
+{
+    ResidualNetwork rnetwork(network);
+    auto const maxflow = edmonds_karp(rnetwork);
     return {maxflow, get_flow_arcs(network, rnetwork)};
 }
 
+/* Same, consuming the network: its arcs are released while the residual network is built, only
+their capacities are kept to retrieve the flow. */
+inline Flow edmonds_karp(FlowNetwork&& network)
+{
+    std::vector<flow_t> capacities;
+    ResidualNetwork rnetwork(std::move(network), capacities);
+    auto const maxflow = edmonds_karp(rnetwork);
+    return {maxflow, get_flow_arcs(capacities, rnetwork)};
+}
+
 
 /* Dinitz algorithm for computing the maximum flow of the given flow network in O(n²m) implemented
 as recommended by Boris V. Cherkassky. Cherkassky's implementation shares actually many features of
-the push-relabel algorithm of Goldberg and Tarjan. */
+the push-relabel algorithm of Goldberg and Tarjan. It runs on any residual network representation
+(ResidualNetwork by default). */
+template <ResidualGraph Network = ResidualNetwork>
 struct DinitzCherkassky
 {
-    FlowNetwork const& network;
-    ResidualNetwork rnetwork;
-    std::vector<std::span<ResidualArc>::iterator> current_arc; // keeps track of visited arcs in the DFS phase loop
+    using ArcIterator = std::ranges::iterator_t<decltype(std::declval<Network const&>().arcs_out(0))>;
+
+    Network rnetwork;
+    FlowNetwork const* network = nullptr; // kept by the caller, to retrieve the flow of each arc
+    std::vector<flow_t> capacities; // of the input arcs of a consumed network, instead
+    std::vector<ArcIterator> current_arc; // keeps track of visited arcs in the DFS phase loop
     std::vector<node_t> rank; // rank(v) is the distance of node v to the sink
     std::vector<node_t> bfs_ordering; // used for the "queue-less" BFS
 
     static constexpr auto Unreached = std::numeric_limits<node_t>::max(); // a symbolic +∞ rank value
     static constexpr auto InfiniteFlow = std::numeric_limits<flow_t>::max(); // a symbolic +∞ flow value
 
-    DinitzCherkassky(FlowNetwork const& network) : network(network), rnetwork(network),
-        current_arc(network.n), rank(network.n), bfs_ordering(network.n) {
-        bfs_ordering[0] = rnetwork.sink;
+    /* The caller keeps the network, which must outlive the solver: operator() reads the capacities
+    from it, none are copied. */
+    DinitzCherkassky(FlowNetwork const& network) requires std::same_as<Network, ResidualNetwork> :
+        DinitzCherkassky(ResidualNetwork(network)) {
+        this->network = &network;
     }
 
-    /* Algorithm's main loop. */
-    Flow operator()() {
+    /* Consumes the network: its arcs are released while the residual network is built, which lowers
+    the peak memory when the caller doesn't need them anymore, and only their capacities are kept. */
+    DinitzCherkassky(FlowNetwork&& network) requires std::same_as<Network, ResidualNetwork> :
+        DinitzCherkassky(std::move(network), std::vector<flow_t>()) {}
+
+    DinitzCherkassky(Network rnetwork) : rnetwork(std::move(rnetwork)),
+        current_arc(this->rnetwork.n), rank(this->rnetwork.n), bfs_ordering(this->rnetwork.n) {}
+
+private:
+    // capacities is filled by the construction of the residual network, before the members exist
+    DinitzCherkassky(FlowNetwork&& network, std::vector<flow_t> capacities) requires std::same_as<Network, ResidualNetwork> :
+        DinitzCherkassky(ResidualNetwork(std::move(network), capacities)) {
+        this->capacities = std::move(capacities);
+    }
+
+public:
+    /* Algorithm's main loop, returns the maximum flow value (the flow itself is left in rnetwork). */
+    flow_t solve() {
         flow_t maxflow = 0;
         while (bfs_compute_rank()) {
             reset_current_arc();
             for (flow_t df = InfiniteFlow; df; maxflow += df)
                 df = dfs_phase_loop(rnetwork.source, InfiniteFlow);
         }
-        return {maxflow, get_flow_arcs(network, rnetwork)};
+        return maxflow;
+    }
+
+    /* Solves and retrieves the flow of each arc of the FlowNetwork the solver was built from, whether
+    the caller kept it or handed it over. */
+    Flow operator()() requires std::same_as<Network, ResidualNetwork> {
+        auto const maxflow = solve();
+        return {maxflow, network ? get_flow_arcs(*network, rnetwork) : get_flow_arcs(capacities, rnetwork)};
     }
 
     void reset_current_arc() {
         for (auto u : rnetwork.nodes())
-            current_arc[u] = begin(rnetwork.arcs_out(u));
+            current_arc[u] = std::ranges::begin(rnetwork.arcs_out(u));
     }
 
     /* The phase is conducted by a single DFS from source. Any satured arc or arc not going from a
@@ -211,11 +565,12 @@ struct DinitzCherkassky
     participate in the remaining part of DFS (thanks to current_arc). */
     flow_t dfs_phase_loop(node_t u, flow_t flow) {
         if (flow == 0 or u == rnetwork.sink) return flow;
-        for (; current_arc[u] != end(rnetwork.arcs_out(u)); ++current_arc[u]) {
-            ResidualArc& arc = *current_arc[u];
-            if (rank[u] == rank[arc.head] + 1 and arc.is_residual()) {
-                if (auto df = dfs_phase_loop(arc.head, std::min(flow, arc.residual_capacity)); df > 0) {
-                    arc.push_flow(df);
+        for (; current_arc[u] != std::ranges::end(rnetwork.arcs_out(u)); ++current_arc[u]) {
+            prefetch_ahead(current_arc[u], std::ranges::end(rnetwork.arcs_out(u)));
+            auto&& arc = *current_arc[u];
+            if (rank[u] == rank[rnetwork.head(arc)] + 1 and rnetwork.residual_capacity(arc) != 0) {
+                if (auto df = dfs_phase_loop(rnetwork.head(arc), std::min(flow, rnetwork.residual_capacity(arc))); df > 0) {
+                    rnetwork.push_flow(arc, df);
                     return df;
                 }
             }
@@ -229,13 +584,34 @@ struct DinitzCherkassky
     bool bfs_compute_rank() {
         std::ranges::fill(rank, Unreached);
         rank[rnetwork.sink] = 0;
+        bfs_ordering[0] = rnetwork.sink; // the terminals may change between solves (see MaxflowQueries)
         auto last = begin(bfs_ordering) + 1;
-        for (auto u = begin(bfs_ordering); u != last; ++u)
-            for (auto& arc : rnetwork.arcs_out(*u))
-                if (rank[arc.head] == Unreached and arc.twin->is_residual()) {
-                    rank[arc.head] = rank[*u] + 1;
-                    *(last++) = arc.head;
+        for (auto u = begin(bfs_ordering); u != last; ++u) {
+            if constexpr (PrefetchDistance > 0 and std::ranges::contiguous_range<decltype(rnetwork.arcs_out(0))>)
+                if (last - u > PrefetchDistance) prefetch(std::ranges::data(rnetwork.arcs_out(u[PrefetchDistance])));
+            auto const arcs = rnetwork.arcs_out(*u);
+            for (auto it = std::ranges::begin(arcs); it != std::ranges::end(arcs); ++it) {
+                prefetch_ahead(it, std::ranges::end(arcs));
+                auto&& arc = *it;
+                if (rank[rnetwork.head(arc)] == Unreached and rnetwork.residual_capacity(rnetwork.twin(arc)) != 0) {
+                    rank[rnetwork.head(arc)] = rank[*u] + 1;
+                    *(last++) = rnetwork.head(arc);
                 }
+            }
+        }
         return rank[rnetwork.source] != Unreached;
     }
+
+    /* Prefetches the rank of the head of the arc PrefetchDistance positions after arc, and its reverse
+    arc if the representation gives it by reference (an index based one keeps it close anyway, or
+    has no way to tell where it is). Only when the arcs can be indexed, a no-op otherwise. */
+    template <typename Iterator>
+    void prefetch_ahead([[maybe_unused]] Iterator arc, [[maybe_unused]] Iterator end) const {
+        if constexpr (PrefetchDistance > 0 and std::random_access_iterator<Iterator>) {
+            if (end - arc <= PrefetchDistance) return;
+            auto&& ahead = arc[PrefetchDistance];
+            prefetch(&rank[rnetwork.head(ahead)]);
+            if constexpr (std::is_lvalue_reference_v<decltype(rnetwork.twin(ahead))>) prefetch(&rnetwork.twin(ahead));
+        }
+    }
 };
\ No newline at end of file
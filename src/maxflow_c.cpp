@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <ranges>
+#include "maxflow.hpp"
+#include "maxflow_c.h"
+
+
+struct maxflow_graph
+{
+    size_t n, m;
+    node_t source, sink;
+    node_t const* tails;
+    node_t const* heads;
+    flow_t const* capacities;
+    std::optional<ResidualNetwork> rnetwork; // holds the flow of the last solve
+    flow_t value = 0;
+
+    /* The caller's arrays seen as a range of CapacityArc, without any copy. */
+    auto arcs() const {
+        return std::views::iota(size_t{0}, m) | std::views::transform([this](size_t a) {
+            return CapacityArc{tails[a], heads[a], capacities[a]};
+        });
+    }
+};
+
+
+/* Runs f and translates the C++ exceptions into status codes, none of them must cross the C ABI. */
+template <typename F>
+static maxflow_status guarded(F&& f) {
+    try {
+        return f();
+    } catch (std::bad_alloc const&) {
+        return MAXFLOW_OUT_OF_MEMORY;
+    } catch (...) {
+        return MAXFLOW_INTERNAL_ERROR;
+    }
+}
+
+
+extern "C" {
+
+maxflow_graph* maxflow_graph_create(size_t n, size_t m, uint32_t source, uint32_t sink,
+    const uint32_t* tails, const uint32_t* heads, const uint32_t* capacities)
+{
+    if (source >= n or sink >= n or source == sink) return nullptr;
+    if (m > 0 and (!tails or !heads or !capacities)) return nullptr;
+    auto const valid_node = [n](node_t u) { return u < n; };
+    if (!std::all_of(tails, tails + m, valid_node) or !std::all_of(heads, heads + m, valid_node)) return nullptr;
+    return new (std::nothrow) maxflow_graph{n, m, source, sink, tails, heads, capacities, std::nullopt, 0};
+}
+
+void maxflow_graph_destroy(maxflow_graph* graph) {
+    delete graph;
+}
+
+maxflow_status maxflow_solve(maxflow_graph* graph, maxflow_engine engine) {
+    if (!graph) return MAXFLOW_INVALID_ARGUMENT;
+    return guarded([&] {
+        graph->rnetwork.reset();
+        ResidualNetwork rnetwork(graph->n, graph->source, graph->sink, graph->arcs());
+        switch (engine) {
+            case MAXFLOW_DINITZ_CHERKASSKY: {
+                DinitzCherkassky solver(std::move(rnetwork));
+                graph->value = solver.solve();
+                graph->rnetwork.emplace(std::move(solver.rnetwork));
+                return MAXFLOW_OK;
+            }
+            case MAXFLOW_EDMONDS_KARP:
+                graph->value = edmonds_karp(rnetwork);
+                graph->rnetwork.emplace(std::move(rnetwork));
+                return MAXFLOW_OK;
+        }
+        return MAXFLOW_INVALID_ARGUMENT;
+    });
+}
+
+uint32_t maxflow_value(const maxflow_graph* graph) {
+    return graph and graph->rnetwork ? graph->value : 0;
+}
+
+maxflow_status maxflow_flow_arcs(const maxflow_graph* graph, uint32_t* flow_arcs) {
+    if (!graph or (!flow_arcs and graph->m > 0)) return MAXFLOW_INVALID_ARGUMENT;
+    if (!graph->rnetwork) return MAXFLOW_NOT_SOLVED;
+    return guarded([&] {
+        std::ranges::copy(get_flow_arcs(graph->arcs(), *graph->rnetwork), flow_arcs);
+        return MAXFLOW_OK;
+    });
+}
+
+size_t maxflow_cut(const maxflow_graph* graph, uint32_t* source_side, size_t capacity) {
+    if (!graph or !graph->rnetwork) return 0;
+    auto const cut = minimum_cut(*graph->rnetwork);
+    if (source_side) std::copy_n(begin(cut), std::min(capacity, std::size(cut)), source_side);
+    return std::size(cut);
+}
+
+maxflow_status maxflow_solve_csr(size_t n, uint32_t source, uint32_t sink,
+    const uint32_t* first_out, const uint32_t* heads, const uint32_t* twins, uint32_t* residual_capacities,
+    maxflow_engine engine, uint32_t* value)
+{
+    if (!first_out or !value or engine != MAXFLOW_DINITZ_CHERKASSKY) return MAXFLOW_INVALID_ARGUMENT;
+    auto const m = size_t{first_out[n]};
+    if (m > 0 and (!heads or !twins or !residual_capacities)) return MAXFLOW_INVALID_ARGUMENT;
+    return guarded([&] {
+        try {
+            DinitzCherkassky solver(ResidualNetworkView(source, sink, std::span(first_out, n + 1),
+                std::span(heads, m), std::span(twins, m), std::span(residual_capacities, m)));
+            *value = solver.solve();
+        } catch (std::invalid_argument const&) {
+            return MAXFLOW_INVALID_ARGUMENT;
+        }
+        return MAXFLOW_OK;
+    });
+}
+
+const char* maxflow_status_string(maxflow_status status) {
+    switch (status) {
+        case MAXFLOW_OK: return "ok";
+        case MAXFLOW_INVALID_ARGUMENT: return "invalid argument";
+        case MAXFLOW_NOT_SOLVED: return "graph not solved";
+        case MAXFLOW_OUT_OF_MEMORY: return "out of memory";
+        case MAXFLOW_INTERNAL_ERROR: return "internal error";
+    }
+    return "unknown status";
+}
+
+}
@@ -0,0 +1,79 @@
+/* C interface of the maximum flow solvers, built as the libmaxflow shared library. It only exposes
+an opaque graph handle and plain integer arrays, so it can be called from any language with a C FFI
+(Python ctypes/cffi, Go cgo, ...). Nodes are 0-based, as in maxflow.hpp. */
+#ifndef MAXFLOW_C_H
+#define MAXFLOW_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* MAXFLOW_BUILDING is defined when building the library itself, its users import the functions. */
+#if defined(_WIN32) && defined(MAXFLOW_BUILDING)
+#  define MAXFLOW_API __declspec(dllexport)
+#elif defined(_WIN32)
+#  define MAXFLOW_API __declspec(dllimport)
+#else
+#  define MAXFLOW_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct maxflow_graph maxflow_graph;
+
+typedef enum maxflow_engine {
+    MAXFLOW_DINITZ_CHERKASSKY = 0,
+    MAXFLOW_EDMONDS_KARP = 1,
+} maxflow_engine;
+
+typedef enum maxflow_status {
+    MAXFLOW_OK = 0,
+    MAXFLOW_INVALID_ARGUMENT = 1,
+    MAXFLOW_NOT_SOLVED = 2,
+    MAXFLOW_OUT_OF_MEMORY = 3,
+    MAXFLOW_INTERNAL_ERROR = 4,
+} maxflow_status;
+
+/* Creates a graph of n nodes and m arcs, arc a going from tails[a] to heads[a] with capacity capaci
+-ties[a]. The arrays are referenced, not copied: they must stay alive and unchanged until the graph
+is destroyed. Returns NULL if an argument is invalid (e.g. a node id out of range) or on allocation
+failure. */
+MAXFLOW_API maxflow_graph* maxflow_graph_create(size_t n, size_t m, uint32_t source, uint32_t sink,
+    const uint32_t* tails, const uint32_t* heads, const uint32_t* capacities);
+
+MAXFLOW_API void maxflow_graph_destroy(maxflow_graph* graph);
+
+/* Computes a maximum flow with the chosen engine. Can be called again (e.g. with another engine),
+the previous result is then discarded. */
+MAXFLOW_API maxflow_status maxflow_solve(maxflow_graph* graph, maxflow_engine engine);
+
+/* Maximum flow value of the last solve, 0 if the graph hasn't been solved. */
+MAXFLOW_API uint32_t maxflow_value(const maxflow_graph* graph);
+
+/* Writes the flow of each arc (m values, in the input order) into the caller's buffer. */
+MAXFLOW_API maxflow_status maxflow_flow_arcs(const maxflow_graph* graph, uint32_t* flow_arcs);
+
+/* Writes at most capacity nodes of the source side of a minimum cut into the caller's buffer and
+returns the total number of such nodes (so a first call with capacity 0 gives the buffer size). */
+MAXFLOW_API size_t maxflow_cut(const maxflow_graph* graph, uint32_t* source_side, size_t capacity);
+
+/* Solves a graph given in the compressed sparse row format without copying it: the arcs out of node
+u are [first_out[u], first_out[u + 1]), arc a goes to heads[a] and its reverse arc is twins[a]. The
+residual_capacities array, initialized with the arc capacities (0 for a pure reverse arc), is updated
+in place: the flow on an arc is the decrease of its residual capacity. first_out has n + 1 entries,
+the other arrays first_out[n]. Only MAXFLOW_DINITZ_CHERKASSKY is supported. Returns
+MAXFLOW_INVALID_ARGUMENT if the arrays are inconsistent (decreasing offsets, a head or reverse arc out
+of range, or a reverse arc which doesn't point back) or if source == sink, checked in O(n + m) before
+solving. */
+MAXFLOW_API maxflow_status maxflow_solve_csr(size_t n, uint32_t source, uint32_t sink,
+    const uint32_t* first_out, const uint32_t* heads, const uint32_t* twins, uint32_t* residual_capacities,
+    maxflow_engine engine, uint32_t* value);
+
+MAXFLOW_API const char* maxflow_status_string(maxflow_status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
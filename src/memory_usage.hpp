@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "maxflow.hpp"
+#include "region_push_relabel.hpp"
+#include "bipartite_matching.hpp"
+#include "unit_capacity.hpp"
+#include "paired_residual_network.hpp"
+#include "compressed_residual_network.hpp"
+#include "incremental_bfs.hpp"
+#include "async_push_relabel.hpp"
+#include "goldberg_rao.hpp"
+
+
+/* The maximum flow algorithms whose memory use can be estimated. */
+enum class Solver
+{
+    DinitzCherkassky,
+    EdmondsKarp,
+    RegionPushRelabel,
+    HopcroftKarp,
+    UnitDinitz,
+    PairedDinitzCherkassky,
+    CompressedDinitzCherkassky,
+    IncrementalBFS,
+    AsyncPushRelabel,
+    GoldbergRao,
+};
+
+
+/* Predicted memory use of a solve in bytes, broken down by data structure. The input network and
+the residual network are alive during the whole solve, while the construction temporaries are freed
+before the solver's own arrays and the output flow are allocated. */
+struct MemoryEstimate
+{
+    size_t flow_network;     // the input arcs list
+    size_t residual_network; // the glued adjacency lists and their spans
+    size_t construction;     // temporaries of the residual network construction (degrees, iterators)
+    size_t solver;           // the solver's working arrays (rank, current_arc, BFS ordering, ...)
+    size_t flow;             // the output flow of each arc, with the temporaries of its extraction
+
+    size_t peak() const { return flow_network + residual_network + std::max(construction, solver + flow); }
+};
+
+
+/* Predicts the memory used to solve a flow network of n nodes and m arcs with the given solver, from
+the actual sizes of the data structures (vectors capacities are assumed to be exact). The residual
+network is counted without any merged antiparallel pair, so it is an upper bound. */
+inline MemoryEstimate estimate_memory(size_t n, size_t m, Solver solver)
+{
+    auto const pairing = (2 * m + 3 * n) * sizeof(arc_t); // see antiparallel_partners
+    MemoryEstimate estimate;
+    estimate.flow_network = m * sizeof(CapacityArc);
+    estimate.residual_network = 2 * m * sizeof(ResidualArc) + n * sizeof(std::span<ResidualArc>) + m * sizeof(arc_t);
+    estimate.construction = n * sizeof(node_t) + (n + 1) * sizeof(std::vector<ResidualArc>::iterator) + pairing;
+    estimate.flow = m * sizeof(flow_t);
+    switch (solver) {
+        case Solver::DinitzCherkassky:
+            estimate.solver = n * (sizeof(DinitzCherkassky<>::ArcIterator) + 2 * sizeof(node_t));
+            break;
+        case Solver::IncrementalBFS: // side, label, parent, current arc, excess and the fronts
+            estimate.solver = n * (sizeof(IncrementalBFS::Side) + 2 * sizeof(node_t) + sizeof(ResidualArc*) + sizeof(arc_t)
+                + sizeof(std::int64_t)) + m * sizeof(flow_t);
+            break;
+        case Solver::AsyncPushRelabel: // excess, label, active flag, BFS arrays and the queues (n nodes at most)
+            estimate.solver = n * (sizeof(std::uint64_t) + 4 * sizeof(node_t) + sizeof(bool));
+            break;
+        case Solver::GoldbergRao: // its own arrays, with a current arc of each component and the DFS path
+            estimate.solver = n * (9 * sizeof(node_t) + sizeof(std::int64_t) + 4 * sizeof(ResidualArc*)
+                + sizeof(std::pair<node_t, arc_t>)) + m * sizeof(flow_t);
+            break;
+        case Solver::EdmondsKarp:
+            estimate.solver = n * (sizeof(node_t) + sizeof(ResidualArc*));
+            break;
+        case Solver::RegionPushRelabel: // excess, label, current arc, BFS ordering and the active queues
+            estimate.solver = n * (sizeof(std::uint64_t) + 3 * sizeof(node_t)
+                + sizeof(RegionPushRelabel<ResidualNetwork>::ArcIterator)) + n / 8;
+            break;
+        case Solver::HopcroftKarp: // no residual network but the bipartite graph (n bounds both sides)
+            estimate.residual_network = m * (sizeof(node_t) + sizeof(arc_t)) + 2 * n * sizeof(arc_t);
+            estimate.construction = n * (1 + 2 * sizeof(node_t));
+            estimate.solver = n * (4 * sizeof(node_t) + sizeof(arc_t)) + n / 8;
+            estimate.flow = m * sizeof(flow_t);
+            break;
+        case Solver::PairedDinitzCherkassky: // the paired arcs layout, and the input arcs positions
+            estimate.residual_network = 2 * m * (sizeof(PairedArc) + sizeof(flow_t)) + m * sizeof(arc_t)
+                + (n + 1) * sizeof(arc_t);
+            estimate.construction = pairing + n * sizeof(arc_t);
+            estimate.solver = n * (sizeof(DinitzCherkassky<PairedResidualNetwork>::ArcIterator) + 2 * sizeof(node_t));
+            estimate.flow = m * sizeof(flow_t);
+            break;
+        case Solver::CompressedDinitzCherkassky: // assuming 2 bytes per encoded head and no merged arcs
+            estimate.residual_network = 2 * m * (2 + sizeof(std::uint64_t)) + (n + 1) * (2 * sizeof(arc_t) + sizeof(std::uint64_t))
+                + 2 * m / CompressedResidualNetwork::SkipInterval * sizeof(CompressedResidualNetwork::SkipEntry);
+            estimate.construction = 2 * m * 2 * sizeof(std::uint64_t) + 3 * n * sizeof(arc_t); // padded neighbors
+            estimate.solver = n * (sizeof(DinitzCherkassky<CompressedResidualNetwork>::ArcIterator) + 2 * sizeof(node_t));
+            estimate.flow = m * sizeof(flow_t) + 2 * m * sizeof(std::uint64_t);
+            break;
+        case Solver::UnitDinitz: // the bit-packed residual network, and its input arcs positions
+            estimate.residual_network = 2 * m * (sizeof(node_t) + sizeof(arc_t)) + m / 4 + m * sizeof(arc_t)
+                + (n + 1) * sizeof(arc_t);
+            estimate.construction = n * sizeof(arc_t);
+            estimate.solver = n * (sizeof(arc_t) + 2 * sizeof(node_t) + sizeof(arc_t));
+            estimate.flow = m * sizeof(flow_t);
+            break;
+    }
+    return estimate;
+}
+
+
+/* Resets the peak resident set size of the process, so that peak_rss() then measures the peak of
+what follows. Only supported on Linux (through /proc/self/clear_refs), returns false otherwise. */
+inline bool reset_peak_rss() {
+    auto file = std::fopen("/proc/self/clear_refs", "w");
+    if (!file) return false;
+    bool const reset = std::fputs("5", file) >= 0;
+    return std::fclose(file) == 0 and reset;
+}
+
+
+/* Peak resident set size of the process in bytes (the "high water mark"), 0 if unavailable. */
+inline size_t peak_rss() {
+    auto file = std::fopen("/proc/self/status", "r");
+    if (!file) return 0;
+    size_t kilobytes = 0;
+    char line[256];
+    while (std::fgets(line, sizeof(line), file))
+        if (std::strncmp(line, "VmHWM:", 6) == 0) {
+            std::sscanf(line + 6, "%zu", &kilobytes);
+            break;
+        }
+    std::fclose(file);
+    return kilobytes * 1024;
+}
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "maxflow.hpp"
+
+
+/* Index in the glued adjacency lists of the first arc out of node u (m for u = n). */
+inline size_t first_arc_index(ResidualNetwork const& rnetwork, size_t u) {
+    return u == rnetwork.n ? rnetwork.m : rnetwork.arcs_out_span[u].data() - rnetwork.adjlist.data();
+}
+
+
+/* A message about an arc of the receiver: a flow pushed on its reverse arc, or the label of its head. */
+struct ArcMessage
+{
+    arc_t arc;
+    flow_t value;
+};
+
+
+/* A stand-in for MPI between processes of a single machine: every pair of processes is connected by
+a UNIX socket pair and the only collective operation is an all-to-all exchange of message batches,
+each batch carrying a header value which is summed over all the processes (an "all-reduce"). */
+struct ProcessGroup
+{
+    size_t rank, size;
+    std::vector<int> sockets; // sockets[q] is connected to process q (-1 for the process itself)
+
+    /* Sends outgoing[q] to every other process q and returns the messages received from all of them,
+    along with the sum of all the headers (the local one included). Non-blocking sockets are polled
+    so that no process waits on a full socket buffer while its peer does the same. */
+    std::uint64_t exchange(std::vector<std::vector<ArcMessage>>& outgoing, std::uint64_t header,
+        std::vector<ArcMessage>& incoming)
+    {
+        struct Channel {
+            std::vector<char> send, receive;
+            size_t sent = 0, received = 0, expected = 2 * sizeof(std::uint64_t);
+        };
+        std::vector<Channel> channels(size);
+        for (size_t q = 0; q < size; ++q) {
+            if (q == rank) continue;
+            std::uint64_t const batch_header[] = {header, std::size(outgoing[q])};
+            auto& send = channels[q].send;
+            send.resize(sizeof(batch_header) + std::size(outgoing[q]) * sizeof(ArcMessage));
+            std::memcpy(send.data(), batch_header, sizeof(batch_header));
+            std::memcpy(send.data() + sizeof(batch_header), outgoing[q].data(), std::size(outgoing[q]) * sizeof(ArcMessage));
+            outgoing[q].clear();
+        }
+
+        std::vector<pollfd> polled;
+        for (bool pending = true; pending;) {
+            polled.clear();
+            for (size_t q = 0; q < size; ++q) {
+                if (q == rank) continue;
+                auto const& channel = channels[q];
+                short events = (channel.sent < std::size(channel.send) ? POLLOUT : 0)
+                             | (channel.received < channel.expected ? POLLIN : 0);
+                if (events) polled.push_back({sockets[q], events, 0});
+            }
+            pending = !polled.empty();
+            if (!pending) break;
+            if (poll(polled.data(), std::size(polled), -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Cannot poll the process group sockets.");
+            }
+            for (auto const& fd : polled) {
+                auto const q = static_cast<size_t>(std::ranges::find(sockets, fd.fd) - begin(sockets));
+                auto& channel = channels[q];
+                if (fd.revents & POLLOUT) {
+                    auto const n = ::send(fd.fd, channel.send.data() + channel.sent,
+                        std::size(channel.send) - channel.sent, MSG_NOSIGNAL);
+                    if (n < 0 and errno != EAGAIN) throw std::runtime_error("A process of the group is gone.");
+                    if (n > 0) channel.sent += n;
+                }
+                if (fd.revents & (POLLIN | POLLHUP | POLLERR)) {
+                    channel.receive.resize(channel.expected);
+                    auto const n = ::recv(fd.fd, channel.receive.data() + channel.received,
+                        channel.expected - channel.received, 0);
+                    if (n == 0 or (n < 0 and errno != EAGAIN)) throw std::runtime_error("A process of the group is gone.");
+                    if (n > 0) channel.received += n;
+                    if (channel.received == 2 * sizeof(std::uint64_t) and channel.expected == channel.received) {
+                        std::uint64_t count;
+                        std::memcpy(&count, channel.receive.data() + sizeof(std::uint64_t), sizeof(count));
+                        channel.expected += count * sizeof(ArcMessage);
+                    }
+                }
+            }
+        }
+
+        incoming.clear();
+        for (size_t q = 0; q < size; ++q) {
+            if (q == rank) continue;
+            auto const& receive = channels[q].receive;
+            std::uint64_t peer_header;
+            std::memcpy(&peer_header, receive.data(), sizeof(peer_header));
+            header += peer_header;
+            auto const count = (std::size(receive) - 2 * sizeof(std::uint64_t)) / sizeof(ArcMessage);
+            auto const first = std::size(incoming);
+            incoming.resize(first + count);
+            std::memcpy(incoming.data() + first, receive.data() + 2 * sizeof(std::uint64_t), count * sizeof(ArcMessage));
+        }
+        return header;
+    }
+
+    std::uint64_t all_reduce_sum(std::uint64_t value) {
+        std::vector<std::vector<ArcMessage>> nothing(size);
+        std::vector<ArcMessage> incoming;
+        return exchange(nothing, value, incoming);
+    }
+};
+
+
+/* One process of the distributed push-relabel algorithm. It owns the nodes [first, last) and the arcs
+out of them: it is the only one to read or update their residual capacities (its copy of the others
+is stale), the state of the other nodes being known through messages only. The residual network is
+the one of the parent process, inherited when forking, so all the processes agree on the arc
+indices. Its rounds are:
+    1. deliver the batches of flow pushed across the partition boundary,
+    2. global relabeling with a level-synchronous distributed BFS, then exchange of the labels of the
+       boundary nodes ("ghost" labels),
+    3. saturation of the source arcs which reach the sink again (the ghost labels may be stale during
+       a round, so some excess might be returned to the source too early),
+    4. stop if there is no active node and no message anywhere, otherwise local discharge (bounded
+       by the same relabeling work as RegionPushRelabel) with the pushes to foreign nodes batched. */
+struct PushRelabelProcess
+{
+    ResidualNetwork& rnetwork;
+    ProcessGroup& group;
+    std::vector<node_t> const& partition_first; // process q owns [partition_first[q], partition_first[q + 1])
+    node_t first, last;
+    std::vector<std::uint64_t> excess;
+    std::vector<node_t> label; // exact for the owned nodes, ghost for the others
+    std::vector<std::span<ResidualArc>::iterator> current_arc;
+    std::deque<node_t> active;
+    std::vector<bool> is_active;
+    std::vector<std::vector<ArcMessage>> outbox; // pending messages of each process
+    std::vector<ArcMessage> inbox;
+    size_t work = 0; // relabeling work of the current round
+
+    static constexpr auto NoLabel = std::numeric_limits<node_t>::max();
+    static constexpr size_t RelabelWork = 12; // cost of a relabel, in addition to the scanned arcs
+
+    PushRelabelProcess(ResidualNetwork& rnetwork, ProcessGroup& group, std::vector<node_t> const& partition_first) :
+        rnetwork(rnetwork), group(group), partition_first(partition_first), first(partition_first[group.rank]),
+        last(partition_first[group.rank + 1]), excess(rnetwork.n), label(rnetwork.n), current_arc(rnetwork.n),
+        is_active(rnetwork.n), outbox(group.size) {}
+
+    bool owns(node_t u) const { return first <= u and u < last; }
+    size_t owner(node_t u) const { return std::ranges::upper_bound(partition_first, u) - begin(partition_first) - 1; }
+    arc_t index(ResidualArc const& arc) const { return static_cast<arc_t>(&arc - rnetwork.adjlist.data()); }
+    ResidualArc& arc_at(arc_t a) const { return rnetwork.adjlist[a]; }
+
+    size_t pending_messages() const {
+        size_t count = 0;
+        for (auto const& messages : outbox) count += std::size(messages);
+        return count;
+    }
+
+    /* Returns the maximum flow value (the same in all processes). */
+    flow_t run() {
+        while (true) {
+            deliver_pushes();
+            global_relabel();
+            saturate_source_arcs();
+            if (group.all_reduce_sum(std::size(active) + pending_messages()) == 0) break;
+            discharge();
+        }
+        return static_cast<flow_t>(group.all_reduce_sum(owns(rnetwork.sink) ? excess[rnetwork.sink] : 0));
+    }
+
+    void activate(node_t u) {
+        if (is_active[u] or u == rnetwork.source or u == rnetwork.sink) return;
+        is_active[u] = true;
+        active.push_back(u);
+    }
+
+    /* Pushes flow on an arc out of an owned node, the twin arc is updated by its owner. */
+    void push(ResidualArc& arc, flow_t delta) {
+        auto const v = arc.head;
+        arc.residual_capacity -= delta;
+        if (owns(v)) {
+            arc.twin->residual_capacity += delta;
+            excess[v] += delta;
+            activate(v);
+        } else {
+            outbox[owner(v)].push_back({index(*arc.twin), delta});
+        }
+    }
+
+    void deliver_pushes() {
+        group.exchange(outbox, 0, inbox);
+        for (auto [a, delta] : inbox) {
+            auto& arc = arc_at(a);
+            auto const u = arc.twin->head; // the tail of the arc, an owned node
+            arc.residual_capacity += delta;
+            excess[u] += delta;
+            activate(u);
+        }
+    }
+
+    void saturate_source_arcs() {
+        if (!owns(rnetwork.source)) return;
+        for (auto& arc : rnetwork.arcs_out(rnetwork.source))
+            if (arc.is_residual() and label[arc.head] < rnetwork.n) push(arc, arc.residual_capacity);
+    }
+
+    /* Discharges the active nodes until the relabels cost as much as a relabel of every owned node and
+    two scans of their arcs, when the next round's global relabeling is due. */
+    void discharge() {
+        work = 0;
+        auto const max_work = RelabelWork * size_t{last - first}
+            + 2 * (first_arc_index(rnetwork, last) - first_arc_index(rnetwork, first));
+        while (!active.empty() and work <= max_work) {
+            auto const u = active.front();
+            active.pop_front();
+            is_active[u] = false;
+            while (excess[u] > 0) {
+                if (current_arc[u] == end(rnetwork.arcs_out(u))) {
+                    relabel(u);
+                    continue;
+                }
+                auto& arc = *current_arc[u];
+                if (arc.is_residual() and label[u] == label[arc.head] + 1) {
+                    auto const delta = static_cast<flow_t>(std::min<std::uint64_t>(excess[u], arc.residual_capacity));
+                    push(arc, delta);
+                    excess[u] -= delta;
+                    if (arc.is_saturated()) ++current_arc[u];
+                } else {
+                    ++current_arc[u];
+                }
+            }
+        }
+    }
+
+    void relabel(node_t u) {
+        auto min_label = NoLabel;
+        work += RelabelWork + rnetwork.degree_out(u);
+        for (auto const& arc : rnetwork.arcs_out(u))
+            if (arc.is_residual()) min_label = std::min(min_label, label[arc.head]);
+        label[u] = min_label + 1;
+        current_arc[u] = begin(rnetwork.arcs_out(u));
+    }
+
+    /* Distributed BFS on the reverse residual arcs, one level per exchange: a node labeled at level d
+    labels its owned neighbors at level d + 1 directly, and notifies the owner of its foreign ones,
+    which checks the residual capacity of its own arc. */
+    void bfs(node_t root) {
+        std::vector<node_t> frontier, next;
+        if (owns(root)) frontier.push_back(root);
+        while (true) {
+            next.clear();
+            for (auto x : frontier)
+                for (auto& arc : rnetwork.arcs_out(x)) {
+                    auto const y = arc.head;
+                    if (!owns(y)) outbox[owner(y)].push_back({index(*arc.twin), label[x]});
+                    else if (label[y] == NoLabel and arc.twin->is_residual()) {
+                        label[y] = label[x] + 1;
+                        next.push_back(y);
+                    }
+                }
+            auto const activity = group.exchange(outbox, std::size(next) + pending_messages(), inbox);
+            for (auto [a, x_label] : inbox) {
+                auto const& arc = arc_at(a);
+                auto const y = arc.twin->head;
+                if (label[y] == NoLabel and arc.is_residual()) {
+                    label[y] = x_label + 1;
+                    next.push_back(y);
+                }
+            }
+            if (activity == 0) break; // the same decision in all the processes
+            std::swap(frontier, next);
+        }
+    }
+
+    void global_relabel() {
+        std::ranges::fill(label, NoLabel);
+        label[rnetwork.sink] = 0;
+        label[rnetwork.source] = static_cast<node_t>(rnetwork.n);
+        bfs(rnetwork.sink);
+        bfs(rnetwork.source);
+        for (node_t u = first; u < last; ++u) {
+            if (label[u] == NoLabel) label[u] = static_cast<node_t>(2 * rnetwork.n);
+            current_arc[u] = begin(rnetwork.arcs_out(u));
+        }
+        // ghost labels of the foreign neighbors of the boundary nodes
+        for (node_t u = first; u < last; ++u)
+            for (auto const& arc : rnetwork.arcs_out(u))
+                if (!owns(arc.head)) outbox[owner(arc.head)].push_back({index(*arc.twin), label[u]});
+        group.exchange(outbox, 0, inbox);
+        for (auto [a, head_label] : inbox) label[arc_at(a).head] = head_label;
+    }
+};
+
+
+/* Splits the nodes into process_count ranges of consecutive nodes with about the same number of arcs. */
+inline std::vector<node_t> partition_nodes(ResidualNetwork const& rnetwork, size_t process_count) {
+    std::vector<node_t> partition_first{0};
+    size_t arcs = 0;
+    for (auto u : rnetwork.nodes()) {
+        if (arcs * process_count >= rnetwork.m * std::size(partition_first) and u > partition_first.back()
+            and std::size(partition_first) < process_count)
+            partition_first.push_back(u);
+        arcs += rnetwork.degree_out(u);
+    }
+    partition_first.push_back(static_cast<node_t>(rnetwork.n));
+    return partition_first;
+}
+
+
+/* Distributed maximum flow: the residual network is partitioned by node ranges among process_count
+forked processes running the push-relabel algorithm of PushRelabelProcess, exchanging batches of
+messages for the arcs across the partitions. The processes write the residual capacities of their
+own arcs in a shared memory result buffer, from which the parent process retrieves the flow. */
+inline Flow multiprocess_push_relabel(FlowNetwork const& network, size_t process_count)
+{
+    ResidualNetwork rnetwork(network);
+    auto const partition_first = partition_nodes(rnetwork, std::max<size_t>(process_count, 1));
+    process_count = std::size(partition_first) - 1;
+
+    auto const result_size = sizeof(std::uint64_t) + rnetwork.m * sizeof(flow_t);
+    auto result = mmap(nullptr, result_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED) throw std::runtime_error("Cannot map the result buffer.");
+    auto const result_value = static_cast<std::uint64_t*>(result);
+    auto const result_capacities = reinterpret_cast<flow_t*>(result_value + 1);
+
+    std::vector<std::vector<int>> sockets(process_count, std::vector<int>(process_count, -1));
+    for (size_t p = 0; p < process_count; ++p)
+        for (size_t q = p + 1; q < process_count; ++q) {
+            int pair[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) throw std::runtime_error("Cannot create the sockets.");
+            fcntl(pair[0], F_SETFL, O_NONBLOCK);
+            fcntl(pair[1], F_SETFL, O_NONBLOCK);
+            sockets[p][q] = pair[0];
+            sockets[q][p] = pair[1];
+        }
+
+    std::vector<pid_t> workers;
+    for (size_t p = 0; p < process_count; ++p) {
+        auto const pid = fork();
+        if (pid == 0) {
+            for (size_t q = 0; q < process_count; ++q)
+                for (size_t r = 0; r < process_count; ++r)
+                    if (q != p and sockets[q][r] >= 0) close(sockets[q][r]);
+            int status = 0;
+            try {
+                ProcessGroup group{p, process_count, sockets[p]};
+                PushRelabelProcess process(rnetwork, group, partition_first);
+                auto const maxflow = process.run();
+                if (p == 0) *result_value = maxflow;
+                auto const last_arc = first_arc_index(rnetwork, partition_first[p + 1]);
+                for (auto a = first_arc_index(rnetwork, partition_first[p]); a < last_arc; ++a)
+                    result_capacities[a] = rnetwork.adjlist[a].residual_capacity;
+            } catch (...) {
+                status = 1;
+            }
+            _exit(status);
+        }
+        if (pid > 0) workers.push_back(pid);
+    }
+    for (auto& peer_sockets : sockets)
+        for (auto fd : peer_sockets) if (fd >= 0) close(fd);
+
+    bool success = std::size(workers) == process_count;
+    for (auto pid : workers) {
+        int status;
+        if (waitpid(pid, &status, 0) != pid or !WIFEXITED(status) or WEXITSTATUS(status) != 0) success = false;
+    }
+    if (success) {
+        for (size_t a = 0; a < rnetwork.m; ++a) rnetwork.adjlist[a].residual_capacity = result_capacities[a];
+    }
+    auto const maxflow = static_cast<flow_t>(*result_value);
+    munmap(result, result_size);
+    if (!success) throw std::runtime_error("A push-relabel process failed.");
+    return {maxflow, get_flow_arcs(network, rnetwork)};
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "maxflow.hpp"
+#include "instance_reader.hpp"
+#include "region_push_relabel.hpp"
+
+
+/* A residual network whose arrays live in a memory-mapped temporary file instead of the heap, so the
+operating system pages them in and out as needed and the graph may exceed the available memory. The
+layout is the one of ResidualNetworkView (CSR arrays, each one page aligned), plus the position of
+each input arc to retrieve its flow. The arcs are streamed from the instance file twice (degrees,
+then arcs), they are never all held in memory: only O(n) arrays are. The indices are 32 bits wide,
+so an instance with 2^31 arcs or more (or 2^32 nodes) is rejected before anything is mapped. The
+file is unlinked as soon as it is mapped, so it disappears with the process. */
+struct MappedResidualNetwork
+{
+    size_t n, m; // number of vertices (resp. residual arcs, twice the number of input arcs)
+    node_t source, sink;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    std::span<arc_t> first_out, twins, original_arc; // original_arc[a] is the residual arc of input arc a
+    std::span<node_t> heads;
+    std::span<flow_t> residual_capacities;
+
+    MappedResidualNetwork(std::string_view instance_filepath, std::filesystem::path const& directory) {
+        FlowNetwork header;
+        std::vector<arc_t> cursor; // out degrees, then first free position of each adjacency list
+        auto const check_sizes = [&] { // once the problem line is read
+            if (header.n > std::numeric_limits<node_t>::max() or header.m > std::numeric_limits<arc_t>::max() / 2)
+                throw std::runtime_error("The instance is too large for 32-bit node and arc indices.");
+        };
+        scan_maxflow_instance(instance_filepath, header, [&](CapacityArc const& arc) {
+            if (cursor.empty()) {
+                check_sizes();
+                cursor.assign(header.n, 0);
+            }
+            ++cursor[arc.tail]; ++cursor[arc.head];
+        });
+        check_sizes();
+        n = header.n; m = 2 * header.m; source = header.source; sink = header.sink;
+        map(directory);
+
+        first_out[0] = 0;
+        for (size_t u = 0; u < n; ++u) first_out[u + 1] = first_out[u] + (cursor.empty() ? 0 : cursor[u]);
+        cursor.assign(begin(first_out), end(first_out) - 1);
+
+        arc_t a = 0;
+        scan_maxflow_instance(instance_filepath, header, [&](CapacityArc const& arc) {
+            auto const [u, v, capacity] = arc;
+            auto const uv = cursor[u]++, vu = cursor[v]++;
+            heads[uv] = v; twins[uv] = vu; residual_capacities[uv] = capacity;
+            heads[vu] = u; twins[vu] = uv; residual_capacities[vu] = 0;
+            original_arc[a++] = uv;
+        });
+    }
+
+    MappedResidualNetwork(MappedResidualNetwork const&) = delete;
+    MappedResidualNetwork& operator=(MappedResidualNetwork const&) = delete;
+    ~MappedResidualNetwork() { if (mapping) munmap(mapping, mapping_size); }
+
+    ResidualNetworkView view() const {
+        return {source, sink, first_out, heads, twins, residual_capacities};
+    }
+
+    /* The flow of each input arc, i.e. the residual capacity of its reverse arc. */
+    std::vector<flow_t> flow_arcs() const {
+        std::vector<flow_t> flow_arcs(std::size(original_arc));
+        for (size_t a = 0; a < std::size(original_arc); ++a)
+            flow_arcs[a] = residual_capacities[twins[original_arc[a]]];
+        return flow_arcs;
+    }
+
+    /* Advises the kernel about the arcs out of the nodes [first, last) (e.g. MADV_WILLNEED before
+    working on them, MADV_DONTNEED after: the file keeps the data). */
+    void advise_arcs(node_t first, node_t last, int advice) const {
+        advise(heads.subspan(first_out[first], first_out[last] - first_out[first]), advice);
+        advise(twins.subspan(first_out[first], first_out[last] - first_out[first]), advice);
+        advise(residual_capacities.subspan(first_out[first], first_out[last] - first_out[first]), advice);
+    }
+
+private:
+    template <typename T>
+    static void advise(std::span<T> array, int advice) {
+        static auto const page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+        auto first = reinterpret_cast<std::uintptr_t>(array.data()) & ~(page_size - 1);
+        auto last = reinterpret_cast<std::uintptr_t>(array.data() + std::size(array));
+        if (last > first) madvise(reinterpret_cast<void*>(first), last - first, advice);
+    }
+
+    void map(std::filesystem::path const& directory) {
+        static auto const page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto const aligned = [](size_t bytes) { return (bytes + page_size - 1) / page_size * page_size; };
+        size_t const sizes[] = {aligned((n + 1) * sizeof(arc_t)), aligned(m * sizeof(node_t)),
+            aligned(m * sizeof(arc_t)), aligned(m * sizeof(flow_t)), aligned(m / 2 * sizeof(arc_t))};
+        for (auto size : sizes) mapping_size += size;
+
+        auto filepath = (directory / "maxflow-XXXXXX").string();
+        int const fd = mkstemp(filepath.data());
+        if (fd < 0) throw std::runtime_error("Cannot create the residual network file.");
+        unlink(filepath.c_str());
+        if (ftruncate(fd, static_cast<off_t>(mapping_size)) == 0)
+            mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (!mapping or mapping == MAP_FAILED) {
+            mapping = nullptr;
+            throw std::runtime_error("Cannot map the residual network file.");
+        }
+
+        auto bytes = static_cast<char*>(mapping);
+        first_out = {reinterpret_cast<arc_t*>(bytes), n + 1}; bytes += sizes[0];
+        heads = {reinterpret_cast<node_t*>(bytes), m}; bytes += sizes[1];
+        twins = {reinterpret_cast<arc_t*>(bytes), m}; bytes += sizes[2];
+        residual_capacities = {reinterpret_cast<flow_t*>(bytes), m}; bytes += sizes[3];
+        original_arc = {reinterpret_cast<arc_t*>(bytes), m / 2};
+    }
+};
+
+
+/* Splits the nodes into ranges whose arcs take at most region_bytes (at least one node per range),
+so that the arcs block of a region fits in the memory budget. */
+inline std::vector<node_t> partition_by_arcs(MappedResidualNetwork const& mnetwork, size_t region_bytes) {
+    constexpr size_t ArcBytes = sizeof(node_t) + sizeof(arc_t) + sizeof(flow_t);
+    auto const region_arcs = std::max<size_t>(region_bytes / ArcBytes, 1);
+    std::vector<node_t> region_first{0};
+    for (node_t u = 0; u < mnetwork.n; ++u)
+        if (u > region_first.back() and mnetwork.first_out[u + 1] - mnetwork.first_out[region_first.back()] > region_arcs)
+            region_first.push_back(u);
+    region_first.push_back(static_cast<node_t>(mnetwork.n));
+    return region_first;
+}
+
+
+/* Out-of-core maximum flow: the region push-relabel algorithm runs on the memory-mapped residual net
+-work, regions being sized so that their arcs block fits in region_bytes. The block of a region is
+prefetched before discharging it and released afterwards, the pushes across the boundary only touch
+the reverse arcs in the neighbor regions, so most of the I/O is sequential. Note that the global
+relabelings still scan the whole graph once per sweep. Returns the maximum flow value, the flow is
+left in the mapped network (see MappedResidualNetwork::flow_arcs). */
+inline flow_t solve_out_of_core(MappedResidualNetwork& mnetwork, size_t region_bytes = size_t{256} << 20)
+{
+    auto const region_first = partition_by_arcs(mnetwork, region_bytes);
+    RegionPushRelabel solver(mnetwork.view(), region_first);
+    return solver.solve([&](size_t r, bool entering) {
+        mnetwork.advise_arcs(region_first[r], region_first[r + 1], entering ? MADV_WILLNEED : MADV_DONTNEED);
+    });
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <ranges>
+#include <span>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* An adjacency entry of PairedResidualNetwork: the head node, and the index of the arc residual
+capacity, i.e. edge << 1 | direction. The reverse arc is the other direction of the same edge. */
+struct PairedArc
+{
+    node_t head;
+    arc_t index;
+};
+
+
+/* Residual network where the two residual capacities of an edge (an arc and its reverse arc) are
+stored side by side in an edge indexed array, so that pushing flow writes a single cache line,
+instead of the two distant ones of ResidualArc (which lives in the adjacency list of its tail, its
+twin in the one of its head). The reverse arc of entry index x is x ^ 1, no twin pointer is stored.
+The adjacency lists are glued in a vector of PairedArc, antiparallel arcs are merged as in
+ResidualNetwork, and the residual capacity index of each input arc is kept to retrieve its flow. */
+struct PairedResidualNetwork
+{
+    size_t n, m; // number of vertices (resp. residual arcs, twice the number of edges)
+    node_t source, sink;
+    std::vector<arc_t> first_out; // the arcs out of u are [first_out[u], first_out[u + 1]) in adjlist
+    std::vector<PairedArc> adjlist;
+    mutable std::vector<flow_t> residual_capacities; // indexed by PairedArc::index
+    std::vector<arc_t> original_arc; // residual capacity index of each input arc
+
+    auto nodes() const { return std::ranges::iota_view{node_t{0}, n}; }
+    auto arcs_out(node_t node) const {
+        return std::span(adjlist).subspan(first_out[node], first_out[node + 1] - first_out[node]);
+    }
+    auto degree_out(node_t node) const { return size_t{first_out[node + 1] - first_out[node]}; }
+
+    // the common adjacency interface (see ResidualGraph), arcs are handled by reference to their
+    // adjacency entry, but a reverse arc is only known by its residual capacity index
+    static node_t head(PairedArc const& arc) { return arc.head; }
+    static arc_t twin(PairedArc const& arc) { return arc.index ^ 1; }
+    flow_t residual_capacity(PairedArc const& arc) const { return residual_capacities[arc.index]; }
+    flow_t residual_capacity(arc_t index) const { return residual_capacities[index]; }
+    void push_flow(PairedArc const& arc, flow_t flow) const {
+        residual_capacities[arc.index] -= flow;
+        residual_capacities[arc.index ^ 1] += flow;
+    }
+
+    PairedResidualNetwork(FlowNetwork const& network) : n(network.n), m(0), source(network.source),
+        sink(network.sink), first_out(n + 1, 0), original_arc(network.m)
+    {
+        auto const partner = antiparallel_partners(n, network.arcs);
+        for (size_t a = 0; a < network.m; ++a)
+            if (partner[a] == NoPartner or partner[a] > a) {
+                ++first_out[network.arcs[a].tail + 1]; ++first_out[network.arcs[a].head + 1];
+                m += 2;
+            }
+        for (size_t u = 0; u < n; ++u) first_out[u + 1] += first_out[u];
+        adjlist.resize(m);
+        residual_capacities.resize(m);
+
+        std::vector<arc_t> cursor(begin(first_out), end(first_out) - 1);
+        arc_t index = 0;
+        for (size_t a = 0; a < network.m; ++a) {
+            if (partner[a] != NoPartner and partner[a] < a) {
+                original_arc[a] = original_arc[partner[a]] ^ 1;
+                continue;
+            }
+            auto const [u, v, capacity] = network.arcs[a];
+            adjlist[cursor[u]++] = {v, index};
+            adjlist[cursor[v]++] = {u, index ^ 1};
+            residual_capacities[index] = capacity;
+            residual_capacities[index ^ 1] = partner[a] == NoPartner ? 0 : network.arcs[partner[a]].capacity;
+            original_arc[a] = index;
+            index += 2;
+        }
+    }
+
+    /* The flow of each input arc: its capacity minus its residual capacity (0 if the net flow of a
+    merged pair goes the other way). */
+    std::vector<flow_t> flow_arcs(FlowNetwork const& network) const {
+        std::vector<flow_t> flow_arcs(network.m);
+        for (size_t a = 0; a < network.m; ++a) {
+            auto const capacity = network.arcs[a].capacity, residual = residual_capacities[original_arc[a]];
+            flow_arcs[a] = capacity > residual ? capacity - residual : 0;
+        }
+        return flow_arcs;
+    }
+};
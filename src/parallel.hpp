@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+/* Number of threads used by the parallel helpers (at least one, even if the hardware concurrency
+can't be determined). */
+inline unsigned thread_count() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+/* Splits the index range [0, count) into contiguous chunks, one per thread, and calls task(first,
+last) on each of them concurrently. The calling thread processes the first chunk itself, so there
+is no thread creation at all on a single core machine or for small ranges. */
+template <typename Task>
+void parallel_for(std::size_t count, Task&& task, std::size_t min_chunk_size = 1 << 14)
+{
+    auto const chunks = std::clamp<std::size_t>(count / min_chunk_size, 1, thread_count());
+    auto const chunk_first = [&](std::size_t chunk) { return count * chunk / chunks; };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(chunks - 1);
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+        workers.emplace_back([&, chunk] { task(chunk_first(chunk), chunk_first(chunk + 1)); });
+    task(chunk_first(0), chunk_first(1));
+}
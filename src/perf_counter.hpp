@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+/* A hardware event counter of the calling process and the threads it creates afterwards, through
+Linux's perf_event_open (user space only). Counters are often unavailable, e.g. in virtual machines
+or with a restrictive kernel.perf_event_paranoid: value() is then empty, the caller reports n/a. */
+struct PerfCounter
+{
+    int fd = -1;
+
+    explicit PerfCounter(std::uint64_t config = PERF_COUNT_HW_CACHE_MISSES) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = config;
+        attributes.disabled = 1;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    PerfCounter(PerfCounter const&) = delete;
+    PerfCounter& operator=(PerfCounter const&) = delete;
+    ~PerfCounter() { if (fd >= 0) close(fd); }
+
+    /* The number of events since the construction. */
+    std::optional<std::uint64_t> value() const {
+        std::uint64_t count;
+        if (fd < 0 or read(fd, &count, sizeof(count)) != sizeof(count)) return {};
+        return count;
+    }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "maxflow.hpp"
+
+
+/* The width and height of the pixel grid of an instance with a "c regulargrid <width> <height>"
+comment (as in the BVZ and KZ2 stereo instances), read from the header only. */
+inline std::optional<std::pair<size_t, size_t>> read_regular_grid(std::string_view filepath) {
+    std::ifstream file;
+    file.open(filepath.data());
+    for (std::string line; std::getline(file, line) and !line.starts_with("a");) {
+        size_t width = 0, height = 0;
+        if (std::sscanf(line.c_str(), "c regulargrid %zu %zu", &width, &height) == 2) return std::pair(width, height);
+    }
+    return {};
+}
+
+
+/* The links of a 4-connected pixel grid instance, where the source is node 0, the sink node 1 and the
+pixels are numbered row by row from 2 on (as in the BVZ instances): each pixel p has a slot for its
+link from the source, to the sink, to its right neighbor and to its down neighbor, numbered
+LinkCount * p + Link. */
+struct PixelGrid
+{
+    enum Link { SourceLink, SinkLink, RightLink, DownLink, LinkCount }; // the links of pixel p, from p
+                                                                      // (but from the source for SourceLink)
+    size_t width, height;
+
+    size_t pixel_count() const { return width * height; }
+    std::pair<node_t, node_t> ends(size_t link) const {
+        auto const p = static_cast<node_t>(2 + link / LinkCount);
+        switch (link % LinkCount) {
+            case SourceLink: return {0, p};
+            case SinkLink: return {p, 1};
+            case RightLink: return {p, p + 1};
+            default: return {p, static_cast<node_t>(p + width)};
+        }
+    }
+
+    /* The slot of the arc (u, v): its link and whether it goes along the link. */
+    std::pair<size_t, bool> link(node_t u, node_t v) const {
+        auto const n = pixel_count() + 2;
+        if (u < n and v < n and u != v) {
+            if (u == 0 and v >= 2) return {LinkCount * (v - 2) + SourceLink, true};
+            if (v == 0 and u >= 2) return {LinkCount * (u - 2) + SourceLink, false};
+            if (v == 1 and u >= 2) return {LinkCount * (u - 2) + SinkLink, true};
+            if (u == 1 and v >= 2) return {LinkCount * (v - 2) + SinkLink, false};
+            if (u >= 2 and v >= 2) {
+                auto const p = std::min(u, v) - 2, q = std::max(u, v) - 2;
+                if (q == p + 1 and q % width != 0) return {LinkCount * p + RightLink, u < v};
+                if (q == p + width) return {LinkCount * p + DownLink, u < v};
+            }
+        }
+        throw std::runtime_error("The instance has an arc which isn't in the grid.");
+    }
+};
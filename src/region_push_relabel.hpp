@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* Push-relabel algorithm of Goldberg and Tarjan where the nodes are partitioned into regions (ranges
+of consecutive nodes, so that the arcs out of a region are contiguous in the residual network) which
+are discharged one at a time: all the active nodes of a region are discharged before moving on to the
+next one, the pushes across the region boundary just activate the head node in its own region. Each
+sweep over the regions starts with a global relabeling (exact distances to the sink, or n + distance
+to the source for the nodes which can't reach the sink anymore), so the excesses which can't reach
+the sink flow back to the source and the final preflow is a flow. As in Cherkassky and Goldberg's
+hi_pr, a sweep ends as soon as the relabeling work exceeds O(n + m), the next one resuming from the
+region where it stopped.
+
+Any valid sequence of pushes and relabels leads to a maximum flow, processing the regions in turn
+only improves the locality: the solver works on a single region arcs block at a time, which is what
+the out-of-core and multi-process solvers rely on. */
+template <ResidualGraph Network>
+struct RegionPushRelabel
+{
+    using ArcIterator = std::ranges::iterator_t<decltype(std::declval<Network const&>().arcs_out(0))>;
+
+    Network rnetwork;
+    std::vector<node_t> region_first; // region r is the nodes range [region_first[r], region_first[r + 1])
+    std::vector<std::uint64_t> excess;
+    std::vector<node_t> label; // a valid distance labeling: label(u) <= label(v) + 1 for residual (u, v)
+    std::vector<ArcIterator> current_arc;
+    std::vector<std::deque<node_t>> active; // the active nodes of each region, in FIFO order
+    std::vector<bool> is_active;
+    std::vector<node_t> bfs_ordering; // used for the "queue-less" BFS of the global relabeling
+    size_t work = 0; // relabeling work since the last global relabeling
+    size_t next_region = 0; // where the next sweep starts
+
+    static constexpr auto NoLabel = std::numeric_limits<node_t>::max();
+    static constexpr size_t RelabelWork = 12; // cost of a relabel, in addition to the scanned arcs
+
+    /* Splits the nodes into region_count regions of (almost) the same number of nodes. */
+    RegionPushRelabel(Network rnetwork, size_t region_count = 1) :
+        RegionPushRelabel(std::move(rnetwork), std::vector<node_t>{}) {
+        region_count = std::clamp<size_t>(region_count, 1, std::max<size_t>(this->rnetwork.n, 1));
+        region_first.resize(region_count + 1);
+        for (size_t r = 0; r <= region_count; ++r) region_first[r] = static_cast<node_t>(this->rnetwork.n * r / region_count);
+        active.resize(region_count);
+    }
+
+    RegionPushRelabel(Network rnetwork, std::vector<node_t> region_first) : rnetwork(std::move(rnetwork)),
+        region_first(std::move(region_first)), excess(this->rnetwork.n), label(this->rnetwork.n),
+        current_arc(this->rnetwork.n), active(std::max<size_t>(std::size(this->region_first), 1) - 1),
+        is_active(this->rnetwork.n), bfs_ordering(this->rnetwork.n) {}
+
+    size_t region_count() const { return std::size(active); }
+
+    size_t region_of(node_t u) const {
+        return std::ranges::upper_bound(region_first, u) - begin(region_first) - 1;
+    }
+
+    bool has_active_nodes() const {
+        return std::ranges::any_of(active, [](auto const& nodes) { return !nodes.empty(); });
+    }
+
+    /* Algorithm's main loop, returns the maximum flow value (the flow itself is left in rnetwork). */
+    flow_t solve() {
+        return solve([](size_t, bool) {});
+    }
+
+    /* Same, calling pager(r, true) before discharging region r and pager(r, false) after, e.g. to
+    bring the region arcs into memory and evict them afterwards. */
+    template <typename Pager>
+    flow_t solve(Pager&& pager) {
+        initialize();
+        while (has_active_nodes()) {
+            global_relabel();
+            for (size_t i = 0; i < region_count() and !global_relabel_due(); ++i) {
+                auto const r = next_region;
+                next_region = (next_region + 1) % region_count();
+                if (active[r].empty()) continue;
+                pager(r, true);
+                discharge_region(r);
+                pager(r, false);
+            }
+        }
+        return static_cast<flow_t>(excess[rnetwork.sink]);
+    }
+
+    /* Saturates all the arcs out of the source. */
+    void initialize() {
+        std::ranges::fill(excess, 0);
+        for (auto&& arc : rnetwork.arcs_out(rnetwork.source))
+            if (auto const rc = rnetwork.residual_capacity(arc); rc != 0) {
+                rnetwork.push_flow(arc, rc);
+                excess[rnetwork.head(arc)] += rc;
+                activate(rnetwork.head(arc));
+            }
+    }
+
+    void activate(node_t u) {
+        if (is_active[u] or u == rnetwork.source or u == rnetwork.sink) return;
+        is_active[u] = true;
+        active[region_of(u)].push_back(u);
+    }
+
+    /* Whether the work since the last global relabeling exceeds a relabel of every node and two scans
+    of the arcs. */
+    bool global_relabel_due() const {
+        return work > RelabelWork * rnetwork.n + 2 * rnetwork.m;
+    }
+
+    /* Discharges the active nodes of region r until there is none or a global relabeling is due (the
+    region is then resumed first by the next sweep). */
+    void discharge_region(size_t r) {
+        if (global_relabel_due()) next_region = r;
+        while (!active[r].empty() and !global_relabel_due()) {
+            auto const u = active[r].front();
+            active[r].pop_front();
+            is_active[u] = false;
+            discharge(u);
+        }
+    }
+
+    /* Pushes the excess of u on its admissible arcs (residual arcs going one level down), relabeling
+    u each time they are exhausted, until u isn't active anymore. */
+    void discharge(node_t u) {
+        while (excess[u] > 0) {
+            if (current_arc[u] == std::ranges::end(rnetwork.arcs_out(u))) {
+                relabel(u);
+                continue;
+            }
+            auto&& arc = *current_arc[u];
+            auto const v = rnetwork.head(arc);
+            auto const rc = rnetwork.residual_capacity(arc);
+            if (rc != 0 and label[u] == label[v] + 1) {
+                auto const delta = static_cast<flow_t>(std::min<std::uint64_t>(excess[u], rc));
+                rnetwork.push_flow(arc, delta);
+                excess[u] -= delta;
+                excess[v] += delta;
+                activate(v);
+                if (delta == rc) ++current_arc[u];
+            } else {
+                ++current_arc[u];
+            }
+        }
+    }
+
+    void relabel(node_t u) {
+        auto min_label = NoLabel;
+        work += RelabelWork + std::ranges::distance(rnetwork.arcs_out(u));
+        for (auto&& arc : rnetwork.arcs_out(u))
+            if (rnetwork.residual_capacity(arc) != 0) min_label = std::min(min_label, label[rnetwork.head(arc)]);
+        label[u] = min_label + 1; // a node with an excess always has a residual path back to the source
+        current_arc[u] = std::ranges::begin(rnetwork.arcs_out(u));
+    }
+
+    /* Sets the labels to the exact distances to the sink in the residual network, or to n plus the
+    distance to the source for the nodes which can't reach the sink, with two "queue-less" BFS on the
+    reverse residual arcs. */
+    void global_relabel() {
+        work = 0;
+        std::ranges::fill(label, NoLabel);
+        label[rnetwork.sink] = 0;
+        label[rnetwork.source] = static_cast<node_t>(rnetwork.n);
+        auto last = begin(bfs_ordering);
+        auto const bfs = [&](node_t root) {
+            *(last++) = root;
+            for (auto u = last - 1; u != last; ++u)
+                for (auto&& arc : rnetwork.arcs_out(*u))
+                    if (label[rnetwork.head(arc)] == NoLabel and rnetwork.residual_capacity(rnetwork.twin(arc)) != 0) {
+                        label[rnetwork.head(arc)] = label[*u] + 1;
+                        *(last++) = rnetwork.head(arc);
+                    }
+        };
+        bfs(rnetwork.sink);
+        bfs(rnetwork.source);
+        for (auto u : rnetwork.nodes()) {
+            if (label[u] == NoLabel) label[u] = static_cast<node_t>(2 * rnetwork.n); // no excess can be there
+            current_arc[u] = std::ranges::begin(rnetwork.arcs_out(u));
+        }
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <span>
+#include <vector>
+#include "maxflow.hpp"
+#include "parallel.hpp"
+
+
+/* The immutable part of a residual network, in the compressed sparse row format: the arcs out of
+node u are [first_out[u], first_out[u + 1]), arc a goes to heads[a] and its reverse arc is twins[a].
+It holds no capacity, so one copy can be shared by any number of concurrent solves of capacity
+scenarios on the same graph, each with its own residual capacities array (4 bytes per residual arc
+instead of a whole residual network), through view(). Built as ResidualNetwork, with the same
+merging of the antiparallel arcs: original_arc is the residual arc of each input arc. */
+struct ResidualTopology
+{
+    size_t n, m; // number of vertices (resp. residual arcs)
+    node_t source, sink;
+    std::vector<arc_t> first_out;
+    std::vector<node_t> heads;
+    std::vector<arc_t> twins;
+    std::vector<arc_t> original_arc;
+
+    ResidualTopology(FlowNetwork const& network) : n(network.n), m(0), source(network.source), sink(network.sink) {
+        ResidualNetwork rnetwork(network);
+        auto const index = [&](ResidualArc const& arc) { return static_cast<arc_t>(&arc - rnetwork.adjlist.data()); };
+        m = rnetwork.m;
+        first_out.resize(n + 1);
+        for (auto u : rnetwork.nodes()) // the lists are glued in the order of the nodes
+            first_out[u] = static_cast<arc_t>(rnetwork.arcs_out_span[u].data() - rnetwork.adjlist.data());
+        first_out[n] = static_cast<arc_t>(m);
+        heads.resize(m);
+        twins.resize(m);
+        parallel_for(m, [&](size_t first, size_t last) {
+            for (auto a = first; a < last; ++a) {
+                heads[a] = rnetwork.adjlist[a].head;
+                twins[a] = index(*rnetwork.adjlist[a].twin);
+            }
+        });
+        original_arc = std::move(rnetwork.original_arc);
+    }
+
+    /* The initial residual capacities of a scenario, from the capacity of each input arc (in the
+    order of the network the topology was built from). */
+    std::vector<flow_t> residual_capacities(std::span<flow_t const> capacities) const {
+        std::vector<flow_t> residual_capacities(m, 0);
+        for (size_t a = 0; a < std::size(capacities); ++a) residual_capacities[original_arc[a]] = capacities[a];
+        return residual_capacities;
+    }
+
+    /* A residual network over the shared topology and the given residual capacities, between the
+    given terminals (by default the ones of the network the topology was built from). */
+    ResidualNetworkView view(std::span<flow_t> residual_capacities) const {
+        return view(residual_capacities, source, sink);
+    }
+    ResidualNetworkView view(std::span<flow_t> residual_capacities, node_t source, node_t sink) const {
+        return ResidualNetworkView(source, sink, first_out, heads, twins, residual_capacities);
+    }
+
+    /* The flow of each input arc, from its capacity and the final residual capacities. */
+    std::vector<flow_t> flow_arcs(std::span<flow_t const> capacities, std::span<flow_t const> residual_capacities) const {
+        std::vector<flow_t> flow_arcs(std::size(capacities));
+        for (size_t a = 0; a < std::size(capacities); ++a) {
+            auto const residual = residual_capacities[original_arc[a]];
+            flow_arcs[a] = capacities[a] > residual ? capacities[a] - residual : 0;
+        }
+        return flow_arcs;
+    }
+};
+
+
+/* Answers maximum flow queries between any terminals of a fixed graph, without building anything per
+query: the graph's residual capacities are computed once, and each query copies them over its working
+array (a single memcpy-like pass), sets its terminals and reruns the solver, whose arrays are kept. */
+struct MaxflowQueries
+{
+    using Query = std::pair<node_t, node_t>; // source, sink
+
+    ResidualTopology topology;
+    std::vector<flow_t> capacities; // the initial residual capacities
+
+    MaxflowQueries(FlowNetwork const& network) : topology(network),
+        capacities(topology.residual_capacities(arc_capacities(network))) {}
+
+    /* The working state of a sequence of queries (one per thread). */
+    struct Worker
+    {
+        MaxflowQueries const& queries;
+        std::vector<flow_t> residual_capacities;
+        DinitzCherkassky<ResidualNetworkView> solver;
+
+        explicit Worker(MaxflowQueries const& queries) : queries(queries), residual_capacities(queries.capacities),
+            solver(queries.topology.view(residual_capacities)) {}
+
+        // the solver's view points into residual_capacities, a copy or a move would share it or leave it dangling
+        Worker(Worker const&) = delete;
+        Worker& operator=(Worker const&) = delete;
+
+        /* The maximum flow value from source to sink, the flow is then in residual_capacities. */
+        flow_t operator()(node_t source, node_t sink) {
+            if (source >= queries.topology.n or sink >= queries.topology.n or source == sink)
+                throw std::invalid_argument("Invalid query terminals.");
+            std::ranges::copy(queries.capacities, begin(residual_capacities));
+            solver.rnetwork.source = source;
+            solver.rnetwork.sink = sink;
+            return solver.solve();
+        }
+    };
+
+    flow_t operator()(node_t source, node_t sink) const { return Worker(*this)(source, sink); }
+
+    /* The maximum flow values of the queries, answered concurrently (each thread with its own working
+    array, the topology being shared). */
+    std::vector<flow_t> operator()(std::span<Query const> queries) const {
+        std::vector<flow_t> maxflows(std::size(queries));
+        parallel_for(std::size(queries), [&](size_t first, size_t last) {
+            Worker worker(*this);
+            for (auto q = first; q < last; ++q) maxflows[q] = worker(queries[q].first, queries[q].second);
+        }, 1);
+        return maxflows;
+    }
+};
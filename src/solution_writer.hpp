@@ -0,0 +1,90 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "maxflow.hpp"
+#include "parallel.hpp"
+
+
+/* Selects the "f" lines written in a solution file. */
+enum class SolutionArcs
+{
+    All,     // one line per arc of the network, in the input order
+    Nonzero, // only the arcs carrying some flow
+    Cut,     // only the arcs going from the source side to the sink side of the given minimum cut
+};
+
+
+/* Formats "f u v flow\n" (1-based node ids as in the DIMACS format) at out, returns the end of it. */
+inline char* format_arc_flow(char* out, CapacityArc const& arc, flow_t flow) {
+    constexpr auto MaxDigits = std::numeric_limits<std::uint64_t>::digits10 + 1;
+    *out++ = 'f'; *out++ = ' ';
+    out = std::to_chars(out, out + MaxDigits, std::uint64_t{arc.tail} + 1).ptr; *out++ = ' ';
+    out = std::to_chars(out, out + MaxDigits, std::uint64_t{arc.head} + 1).ptr; *out++ = ' ';
+    out = std::to_chars(out, out + MaxDigits, flow).ptr; *out++ = '\n';
+    return out;
+}
+
+
+/* Writes the flow in the DIMACS solution format: a "s value" line followed by "f u v flow" lines.
+The arcs are formatted with std::to_chars by chunks, a round of chunks (one per thread) being format
+-ted in parallel into large buffers which are then written in order. No iostream is involved. The
+cut source side (e.g. from minimum_cut) is only needed when writing the cut arcs. Throws if a write
+or the final close fails. */
+inline void write_maxflow_instance_solution(std::string_view filepath, FlowNetwork const& network,
+    Flow const& flow, SolutionArcs selection = SolutionArcs::All, std::span<node_t const> source_side = {})
+{
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::fopen(std::string(filepath).c_str(), "wb"), &std::fclose);
+    if (!file) throw std::runtime_error("Cannot open the solution file.");
+
+    std::vector<std::uint8_t> in_source_side;
+    if (selection == SolutionArcs::Cut) {
+        in_source_side.assign(network.n, false);
+        for (auto u : source_side) in_source_side[u] = true;
+    }
+    auto const is_selected = [&](size_t a) {
+        switch (selection) {
+            case SolutionArcs::Nonzero: return flow.flow_arcs[a] != 0;
+            case SolutionArcs::Cut: return in_source_side[network.arcs[a].tail] and !in_source_side[network.arcs[a].head];
+            default: return true;
+        }
+    };
+
+    char header[32] = "s ";
+    auto header_end = std::to_chars(header + 2, header + sizeof(header) - 1, flow.value).ptr;
+    *header_end++ = '\n';
+    if (std::fwrite(header, 1, header_end - header, file.get()) != size_t(header_end - header))
+        throw std::runtime_error("Cannot write the solution file.");
+
+    constexpr size_t ChunkSize = 1 << 16; // arcs per chunk
+    constexpr size_t MaxLineLength = 2 + 3 * (std::numeric_limits<std::uint64_t>::digits10 + 2);
+    std::vector<std::vector<char>> buffers(thread_count(), std::vector<char>(ChunkSize * MaxLineLength));
+    std::vector<size_t> lengths(std::size(buffers));
+    auto const round_size = std::size(buffers) * ChunkSize;
+
+    for (size_t round_first = 0; round_first < network.m; round_first += round_size) {
+        parallel_for(std::size(buffers), [&](size_t first_chunk, size_t last_chunk) {
+            for (auto chunk = first_chunk; chunk != last_chunk; ++chunk) {
+                auto const first = std::min(network.m, round_first + chunk * ChunkSize);
+                auto const last = std::min(network.m, first + ChunkSize);
+                auto out = buffers[chunk].data();
+                for (auto a = first; a != last; ++a)
+                    if (is_selected(a)) out = format_arc_flow(out, network.arcs[a], flow.flow_arcs[a]);
+                lengths[chunk] = out - buffers[chunk].data();
+            }
+        }, 1);
+        for (size_t chunk = 0; chunk < std::size(buffers); ++chunk)
+            if (std::fwrite(buffers[chunk].data(), 1, lengths[chunk], file.get()) != lengths[chunk])
+                throw std::runtime_error("Cannot write the solution file.");
+    }
+    if (std::fclose(file.release()) != 0) // flushes the buffered end, which may fail too (e.g. a full disk)
+        throw std::runtime_error("Cannot write the solution file.");
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <vector>
+#include "maxflow.hpp"
+
+
+/* Whether all the arcs have a capacity of 1 (edge-disjoint paths, connectivity, ...). */
+inline bool has_unit_capacities(FlowNetwork const& network) {
+    return std::ranges::all_of(network.arcs, [](CapacityArc const& arc) { return arc.capacity == 1; });
+}
+
+
+/* Residual network of a unit-capacity flow network: the residual capacity of an arc is a single bit,
+so the residual state is a bitset next to the heads and twins arrays (8 bytes and a bit per residual
+arc instead of the 16 bytes of a ResidualArc). The layout is the one of ResidualNetworkView, arcs are
+handled by index, and the position of each input arc is kept to retrieve its flow. */
+struct UnitResidualNetwork
+{
+    size_t n, m; // number of vertices (resp. residual arcs, twice the number of input arcs)
+    node_t source, sink;
+    std::vector<arc_t> first_out, twins, original_arc; // original_arc[a] is the residual arc of input arc a
+    std::vector<node_t> heads;
+    mutable std::vector<std::uint64_t> residual; // bit a is set iff arc a is residual (updated by push_flow)
+
+    UnitResidualNetwork(FlowNetwork const& network) : n(network.n), m(2 * network.m), source(network.source),
+        sink(network.sink), first_out(n + 1, 0), twins(m), original_arc(network.m), heads(m), residual((m + 63) / 64, 0)
+    {
+        for (auto const& [u, v, capacity] : network.arcs) { ++first_out[u + 1]; ++first_out[v + 1]; }
+        for (size_t u = 0; u < n; ++u) first_out[u + 1] += first_out[u];
+        std::vector<arc_t> cursor(begin(first_out), end(first_out) - 1);
+        for (size_t a = 0; a < network.m; ++a) {
+            auto const [u, v, capacity] = network.arcs[a];
+            auto const uv = cursor[u]++, vu = cursor[v]++;
+            heads[uv] = v; twins[uv] = vu;
+            heads[vu] = u; twins[vu] = uv;
+            if (capacity != 0) set_residual(uv);
+            original_arc[a] = uv;
+        }
+    }
+
+    auto nodes() const { return std::ranges::iota_view{node_t{0}, n}; }
+    auto arcs_out(node_t node) const { return std::ranges::iota_view{first_out[node], first_out[node + 1]}; }
+    auto degree_out(node_t node) const { return size_t{first_out[node + 1] - first_out[node]}; }
+
+    // the common adjacency interface (see ResidualGraph), a flow is either 0 or 1
+    node_t head(arc_t arc) const { return heads[arc]; }
+    arc_t twin(arc_t arc) const { return twins[arc]; }
+    flow_t residual_capacity(arc_t arc) const { return residual[arc / 64] >> (arc % 64) & 1; }
+    void push_flow(arc_t arc, flow_t flow) const {
+        if (flow == 0) return;
+        residual[arc / 64] &= ~(std::uint64_t{1} << (arc % 64));
+        set_residual(twins[arc]);
+    }
+
+    /* The flow of each input arc: 1 iff its residual arc is saturated (its reverse arc, if an input
+    arc too, is accounted for separately). */
+    std::vector<flow_t> flow_arcs() const {
+        std::vector<flow_t> flow_arcs(std::size(original_arc));
+        for (size_t a = 0; a < std::size(original_arc); ++a) flow_arcs[a] = 1 - residual_capacity(original_arc[a]);
+        return flow_arcs;
+    }
+
+private:
+    void set_residual(arc_t arc) const { residual[arc / 64] |= std::uint64_t{1} << (arc % 64); }
+};
+
+
+/* Dinitz's algorithm specialized for unit capacities, in O(m·min(√m, n^{2/3})) (Even and Tarjan):
+there are at most min(2√m, 2n^{2/3}) phases and a phase costs O(m), since every arc of an augmenting
+path gets saturated and is never scanned again during the phase. The phase is an iterative DFS from
+the source (no flow bottleneck to carry along), a node whose arcs are exhausted leaving the layered
+network. Runs on the bit-packed residual network. */
+struct UnitDinitz
+{
+    UnitResidualNetwork rnetwork;
+    std::vector<arc_t> current_arc;
+    std::vector<node_t> rank; // distance to the sink in the residual network
+    std::vector<node_t> bfs_ordering; // used for the "queue-less" BFS
+    std::vector<arc_t> path; // the arcs of the DFS path
+
+    static constexpr auto Unreached = std::numeric_limits<node_t>::max(); // a symbolic +∞ rank value
+
+    UnitDinitz(FlowNetwork const& network) : rnetwork(network), current_arc(rnetwork.n), rank(rnetwork.n),
+        bfs_ordering(rnetwork.n) {}
+
+    /* Algorithm's main loop, returns the maximum flow value (the flow itself is left in rnetwork). */
+    flow_t solve() {
+        flow_t maxflow = 0;
+        while (bfs_compute_rank()) {
+            std::ranges::copy(begin(rnetwork.first_out), end(rnetwork.first_out) - 1, begin(current_arc));
+            maxflow += blocking_flow();
+        }
+        return maxflow;
+    }
+
+    Flow operator()() {
+        auto const maxflow = solve();
+        return {maxflow, rnetwork.flow_arcs()};
+    }
+
+    /* Augments one unit along each path found by the DFS from the source on the arcs going one rank
+    down, until the source is cut from the sink in the layered network. */
+    flow_t blocking_flow() {
+        flow_t flow = 0;
+        path.clear();
+        auto u = rnetwork.source;
+        while (true) {
+            if (u == rnetwork.sink) {
+                for (auto arc : path) rnetwork.push_flow(arc, 1);
+                ++flow;
+                path.clear();
+                u = rnetwork.source;
+                continue;
+            }
+            auto& arc = current_arc[u];
+            while (arc < rnetwork.first_out[u + 1]
+                and (rank[u] != rank[rnetwork.head(arc)] + 1 or !rnetwork.residual_capacity(arc))) ++arc;
+            if (arc < rnetwork.first_out[u + 1]) {
+                path.push_back(arc);
+                u = rnetwork.head(arc);
+                continue;
+            }
+            if (u == rnetwork.source) return flow;
+            rank[u] = Unreached; // a dead end, retreat
+            u = rnetwork.head(rnetwork.twin(path.back()));
+            path.pop_back();
+            ++current_arc[u];
+        }
+    }
+
+    /* BFS from the sink on the reverse residual arcs, as in DinitzCherkassky. */
+    bool bfs_compute_rank() {
+        std::ranges::fill(rank, Unreached);
+        rank[rnetwork.sink] = 0;
+        bfs_ordering[0] = rnetwork.sink;
+        auto last = begin(bfs_ordering) + 1;
+        for (auto u = begin(bfs_ordering); u != last; ++u)
+            for (auto arc : rnetwork.arcs_out(*u))
+                if (rank[rnetwork.head(arc)] == Unreached and rnetwork.residual_capacity(rnetwork.twin(arc))) {
+                    rank[rnetwork.head(arc)] = rank[*u] + 1;
+                    *(last++) = rnetwork.head(arc);
+                }
+        return rank[rnetwork.source] != Unreached;
+    }
+};
+
+
+/* Dinitz's algorithm, on the bit-packed unit-capacity residual network when all the capacities are 1. */
+inline Flow dinitz(FlowNetwork const& network) {
+    if (has_unit_capacities(network)) return UnitDinitz{network}();
+    return DinitzCherkassky{network}();
+}